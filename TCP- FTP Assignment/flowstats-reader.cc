@@ -0,0 +1,177 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+
+using namespace std;
+
+
+// Reader for the binary flow statistics files (*.flows) written by wired.cc and wireless.cc.
+// Prints one CSV row per (agent, segment size, flow); with --histograms the non-empty
+// delay, jitter and packet-size histogram bins follow as extra rows.
+//
+//   g++ -O2 -o flowstats-reader flowstats-reader.cc
+//   ./flowstats-reader wired_TCP_Veno.flows [--histograms]
+
+const char FLOW_FILE_MAGIC[8] = {'T', 'C', 'P', 'F', 'L', 'O', 'W', '1'};
+
+
+// One histogram of a flow row
+struct Histogram
+{
+  double width;
+  vector<pair<uint32_t, uint32_t> > bins;     // (bin index, count)
+};
+
+
+// One row of the flow statistics file
+struct FlowRow
+{
+  char agent[17];
+  uint32_t segmentSize;
+  uint32_t flowId;
+  uint32_t sourceAddress;
+  uint32_t destinationAddress;
+  uint16_t sourcePort;
+  uint16_t destinationPort;
+  uint8_t protocol;
+  int64_t timeFirstTxNs;
+  int64_t timeFirstRxNs;
+  int64_t timeLastTxNs;
+  int64_t timeLastRxNs;
+  int64_t delaySumNs;
+  int64_t jitterSumNs;
+  int64_t lastDelayNs;
+  uint64_t txBytes;
+  uint64_t rxBytes;
+  uint32_t txPackets;
+  uint32_t rxPackets;
+  uint32_t lostPackets;
+  uint32_t timesForwarded;
+  Histogram histograms[3];
+};
+
+
+template <typename T>
+bool ReadValue (istream &in, T &value)
+{
+  return static_cast<bool> (in.read (reinterpret_cast<char *> (&value), sizeof (T)));
+}
+
+
+bool ReadHistogram (istream &in, Histogram &histogram)
+{
+  uint32_t used;
+  if (!ReadValue (in, histogram.width) || !ReadValue (in, used))
+    {
+      return false;
+    }
+  histogram.bins.resize (used);
+  for (uint32_t i = 0; i < used; i++)
+    {
+      if (!ReadValue (in, histogram.bins[i].first) || !ReadValue (in, histogram.bins[i].second))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+
+// Reads the next row; returns false at the end of the file
+bool ReadRow (istream &in, FlowRow &row)
+{
+  memset (row.agent, 0, sizeof (row.agent));
+  if (!in.read (row.agent, 16))
+    {
+      return false;
+    }
+  bool ok = ReadValue (in, row.segmentSize) && ReadValue (in, row.flowId)
+            && ReadValue (in, row.sourceAddress) && ReadValue (in, row.destinationAddress)
+            && ReadValue (in, row.sourcePort) && ReadValue (in, row.destinationPort)
+            && ReadValue (in, row.protocol)
+            && ReadValue (in, row.timeFirstTxNs) && ReadValue (in, row.timeFirstRxNs)
+            && ReadValue (in, row.timeLastTxNs) && ReadValue (in, row.timeLastRxNs)
+            && ReadValue (in, row.delaySumNs) && ReadValue (in, row.jitterSumNs)
+            && ReadValue (in, row.lastDelayNs)
+            && ReadValue (in, row.txBytes) && ReadValue (in, row.rxBytes)
+            && ReadValue (in, row.txPackets) && ReadValue (in, row.rxPackets)
+            && ReadValue (in, row.lostPackets) && ReadValue (in, row.timesForwarded);
+  for (int h = 0; ok && h < 3; h++)
+    {
+      ok = ReadHistogram (in, row.histograms[h]);
+    }
+  if (!ok)
+    {
+      cerr << "Truncated row in flow statistics file" << endl;
+    }
+  return ok;
+}
+
+
+string FormatAddress (uint32_t address)
+{
+  return to_string ((address >> 24) & 0xff) + "." + to_string ((address >> 16) & 0xff) + "."
+         + to_string ((address >> 8) & 0xff) + "." + to_string (address & 0xff);
+}
+
+
+int main (int argc, char *argv[])
+{
+  if (argc < 2)
+    {
+      cerr << "usage: " << argv[0] << " FILE.flows [--histograms]" << endl;
+      return 1;
+    }
+  bool histograms = argc > 2 && string (argv[2]) == "--histograms";
+
+  ifstream in (argv[1], ios::binary);
+  char magic[8];
+  if (!in.read (magic, sizeof (magic)) || memcmp (magic, FLOW_FILE_MAGIC, sizeof (magic)) != 0)
+    {
+      cerr << argv[1] << " is not a flow statistics file" << endl;
+      return 1;
+    }
+
+  cout << "agent,segment_size,flow_id,source,destination,source_port,destination_port,protocol,"
+       << "first_tx_s,first_rx_s,last_tx_s,last_rx_s,tx_bytes,rx_bytes,tx_packets,rx_packets,"
+       << "lost_packets,times_forwarded,mean_delay_s,mean_jitter_s,throughput_kbps" << endl;
+
+  const char *histogramNames[3] = {"delay", "jitter", "packet_size"};
+  FlowRow row;
+  while (ReadRow (in, row))
+    {
+      double duration = (row.timeLastRxNs - row.timeFirstRxNs) / 1e9;
+      double meanDelay = row.rxPackets > 0 ? row.delaySumNs / 1e9 / row.rxPackets : 0;
+      double meanJitter = row.rxPackets > 1 ? row.jitterSumNs / 1e9 / (row.rxPackets - 1) : 0;
+      double throughput = duration > 0 ? 8.0 * row.rxBytes / (1000 * duration) : 0;
+
+      cout << row.agent << "," << row.segmentSize << "," << row.flowId << ","
+           << FormatAddress (row.sourceAddress) << "," << FormatAddress (row.destinationAddress) << ","
+           << row.sourcePort << "," << row.destinationPort << "," << static_cast<int> (row.protocol) << ","
+           << row.timeFirstTxNs / 1e9 << "," << row.timeFirstRxNs / 1e9 << ","
+           << row.timeLastTxNs / 1e9 << "," << row.timeLastRxNs / 1e9 << ","
+           << row.txBytes << "," << row.rxBytes << "," << row.txPackets << "," << row.rxPackets << ","
+           << row.lostPackets << "," << row.timesForwarded << ","
+           << meanDelay << "," << meanJitter << "," << throughput << endl;
+
+      if (!histograms)
+        {
+          continue;
+        }
+      for (int h = 0; h < 3; h++)
+        {
+          const Histogram &histogram = row.histograms[h];
+          for (size_t b = 0; b < histogram.bins.size (); b++)
+            {
+              cout << "#bin," << row.agent << "," << row.segmentSize << "," << row.flowId << ","
+                   << histogramNames[h] << "," << histogram.bins[b].first * histogram.width << ","
+                   << histogram.width << "," << histogram.bins[b].second << endl;
+            }
+        }
+    }
+  return 0;
+}
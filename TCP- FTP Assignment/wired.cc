@@ -5,9 +5,39 @@
 #include "ns3/applications-module.h"
 #include "ns3/point-to-point-module.h"
 #include "ns3/flow-monitor-module.h"
+#include "ns3/traffic-control-module.h"
+#include "ns3/nix-vector-routing-module.h"
+//the fd-net-device module is only there when ns-3 was configured with it (Linux only)
+#if __has_include("ns3/fd-net-device-module.h")
+#include "ns3/fd-net-device-module.h"
+#define HAVE_FD_NET_DEVICE
+#endif
 #include "ns3/gnuplot.h"
+#ifdef NS3_MPI
+#include "ns3/mpi-interface.h"
+#include <mpi.h>
+#endif
 #include <string>
 #include <fstream>
+#include <vector>
+#include <map>
+#include <memory>
+#include <deque>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <atomic>
+#include <sstream>
+#include <iomanip>
+#include <cstdint>
+#include <chrono>
+#include <cstring>
+#include <cmath>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
 
 
 using namespace std;
@@ -16,119 +46,1319 @@ using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE ("wired");
 
-class SimulatorApp : public Application
+
+// Options shared by every point of the sweep
+struct SweepConfig
 {
-	public:
-  		SimulatorApp ();
-  		virtual ~SimulatorApp ();
-  		void Setup (Ptr<Socket> socket, Address address, uint32_t packetSize, uint32_t nPackets, DataRate dataRate);
+  string agent;
+  uint32_t flows;
+  string topology;                   // dumbbell, leafspine or fattree
+  uint32_t spines;                   // leaf-spine fabric
+  uint32_t leaves;
+  uint32_t hostsPerLeaf;
+  uint32_t fatTreeK;                 // ports per fat-tree switch
+  bool ecmp;                         // global routing sprays packets over equal-cost paths, per packet
+  string accessRate;                 // host to router links
+  string accessDelay;
+  string bottleneckRate;             // RouterToRouter link
+  string bottleneckDelay;
+  double crossUdpLoad;               // UDP on/off cross traffic, as a share of the bottleneck rate (0 = none)
+  double crossWebLoad;               // web-like transfers, as a share of the bottleneck rate (0 = none)
+  double webMeanBytes;               // mean size of the web-like transfers
+  uint32_t crossTcp;                 // competing long-lived TCP flows
+  string crossAgent;                 // their agent, one of CROSS_AGENT_NAMES
+  string crossDelay;                 // one-way delay of each cross-traffic access link
+  string appRate;                    // data rate of every sender
+  uint32_t packetsPerFlow;
+  bool writeXml;                     // also write the per-point FlowMonitor XML files
+  bool trace;                        // sample cwnd, RTT, bytes in flight and goodput over time
+  double traceInterval;              // seconds between samples
+  uint32_t traceBuffer;              // samples buffered before a batch is written
+  bool bulkSend;                     // senders refill the socket buffer instead of pacing
+  bool reusePayload;                 // senders copy a shared payload template per packet
+  string scheduler;                  // event scheduler, one of SCHEDULER_NAMES
+  string routing;                    // global, nix or static
+  bool isolatePoints;                // run every point in a worker process, even with one job
+  string qdisc;                      // queue disc on the bottleneck, one of QDISC_NAMES
+  bool queueBytes;                   // size queues in bytes instead of packets
+  bool queueTrace;                   // record every packet leaving the bottleneck queue
+  double delayBinWidth;              // FlowMonitor delay and jitter histogram bins, in seconds
+  bool sinkMeasure;                  // measure with FlowMeter counters on the hosts instead of FlowMonitor
+  bool ftp;                          // file transfers instead of the constant-rate sender
+  string ftpSizes;                   // file size distribution: fixed, lognormal or pareto
+  double ftpMeanBytes;
+  double ftpArrivalRate;             // Poisson transfers per second and sender (0 = one after another)
+  uint32_t ftpTransfers;             // transfers per sender
+  uint32_t seed;                     // RngSeedManager seed and run number of the point
+  uint32_t run;
+  bool converge;                     // stop a run once its data is delivered or its goodput settles
+  double convergeInterval;           // seconds between two convergence checks
+  uint32_t convergeWindow;           // intervals the goodput must be steady over
+  double convergeTolerance;          // relative 95% confidence half-width counted as steady
+  string cacheDir;                   // reuse results of identical points from here (empty = off)
+  string binaryHash;                 // fingerprint of this executable, part of every cache key
+  bool distributed;                  // run as one logical process of an MPI job
+  uint32_t systemId;
+  uint32_t systemCount;
+};
 
-	private:
-  		virtual void StartApplication (void);
-  		virtual void StopApplication (void);
-
-	  void ScheduleTx (void);
-	  void SendPacket (void);
-
-	  Ptr<Socket>     m_socket;
-	  Address         m_peer;
-	  uint32_t        m_packetSize;
-	  uint32_t        m_nPackets;
-	  DataRate        m_dataRate;
-	  EventId         m_sendEvent;
-	  bool            m_running;
-	  uint32_t        m_packetsSent;
+
+// Receiver-side counters of one flow, taken from the PacketSink Rx trace
+struct SinkStats
+{
+  uint64_t rxBytes;
+  int64_t firstRxNs;
+  int64_t lastRxNs;
 };
 
 
-//Constructor
-SimulatorApp::SimulatorApp ()
+// Per-flow measurements of one sweep point. The forward (data) and reverse (ACK) directions
+// of a TCP connection are separate FlowMonitor flows, told apart by the sink port.
+struct FlowMetrics
 {
-    m_socket=0;
-    m_packetSize=0;
-    m_nPackets=0;
-    m_dataRate=0;
-    m_running=false;
-    m_packetsSent=0;
-}
+  uint32_t flow;
+  double throughput;                 // data direction, IP bytes received, in Kbps
+  double goodput;                    // application bytes received by the PacketSink, in Kbps
+  double lossRate;                   // data packets lost / sent
+  double meanDelay;                  // data one-way delay, in seconds
+  double ackThroughput;              // ACK direction, IP bytes received, in Kbps
+  uint64_t ackPackets;
+};
+
+
+// Results of a single sweep point
+struct SweepResult
+{
+  int segmentSize;
+  double throughput;                 // aggregate over all flows, in Kbps
+  double goodput;                    // aggregate application goodput, in Kbps
+  vector<FlowMetrics> flowMetrics;
+  double fairness;                   // Jain index over the per-flow throughputs
+  vector<double> flowThroughputs;
+  vector<SinkStats> sinkStats;
+  string flowRecords;                // encoded rows of the binary flow statistics file
+  uint64_t events;
+  double wallSeconds;
+  double setupSeconds;               // building the topology and routing, before Simulator::Run ()
+  double routingSeconds;             // of which filling the routing tables
+  uint64_t traceSamples;
+  uint64_t rejectedPackets;          // sends refused by a full socket buffer
+  uint64_t heapAllocations;          // made during Simulator::Run ()
+  double simulatedSeconds;
+  uint64_t peakRssKb;
+  uint32_t stopReason;               // a StopReason
+  uint32_t run;                      // RngSeedManager run number
+  double queueDelayMean;             // bottleneck queueing delay, in seconds
+  double queueDelayMax;
+  double queueBytesMean;             // bytes queued behind a departing packet
+  uint32_t transfersStarted;         // file transfers (ftp workload)
+  uint32_t transfersCompleted;
+  double fctP50;                     // flow completion times, in seconds
+  double fctP99;
+  double fctP999;
+  double slowdownMean;               // completion time over the ideal one
+  double slowdownP99;
+  double delayPercentiles[4];        // p50, p90, p99 and p99.9 one-way delay of the data, in seconds
+  double jitterPercentiles[4];
+  double crossUdpThroughput;         // cross traffic received, in Kbps
+  double crossTcpThroughput;         // all competing long-lived TCP flows
+  double crossWebThroughput;
+  uint32_t webTransfers;             // web-like transfers completed
+  double webFctP99;                  // their p99 completion time, in seconds
+  double agentFairness;              // Jain index over the measured and the competing long-lived flows
+  bool cached;                       // read from the result cache (not serialized)
+};
+
 
+// code shared with wireless.cc
+#include "sweep-common.inc"
 
-//Deconstructor
-SimulatorApp::~SimulatorApp ()
+
+// Encoding of a result for the trip from a worker process back to the parent
+string SerializeResult (const SweepResult &result)
 {
-  m_socket = 0;
+  string buffer;
+  AppendValue (buffer, result.segmentSize);
+  AppendValue (buffer, result.throughput);
+  AppendValue (buffer, result.fairness);
+  AppendValue (buffer, result.goodput);
+  AppendVector (buffer, result.flowMetrics);
+  AppendVector (buffer, result.flowThroughputs);
+  AppendVector (buffer, result.sinkStats);
+  AppendString (buffer, result.flowRecords);
+  AppendValue (buffer, result.events);
+  AppendValue (buffer, result.wallSeconds);
+  AppendValue (buffer, result.setupSeconds);
+  AppendValue (buffer, result.routingSeconds);
+  AppendValue (buffer, result.traceSamples);
+  AppendValue (buffer, result.rejectedPackets);
+  AppendValue (buffer, result.heapAllocations);
+  AppendValue (buffer, result.simulatedSeconds);
+  AppendValue (buffer, result.peakRssKb);
+  AppendValue (buffer, result.stopReason);
+  AppendValue (buffer, result.run);
+  AppendValue (buffer, result.queueDelayMean);
+  AppendValue (buffer, result.queueDelayMax);
+  AppendValue (buffer, result.queueBytesMean);
+  AppendValue (buffer, result.transfersStarted);
+  AppendValue (buffer, result.transfersCompleted);
+  AppendValue (buffer, result.fctP50);
+  AppendValue (buffer, result.fctP99);
+  AppendValue (buffer, result.fctP999);
+  AppendValue (buffer, result.slowdownMean);
+  AppendValue (buffer, result.slowdownP99);
+  AppendValue (buffer, result.delayPercentiles);
+  AppendValue (buffer, result.jitterPercentiles);
+  AppendValue (buffer, result.crossUdpThroughput);
+  AppendValue (buffer, result.crossTcpThroughput);
+  AppendValue (buffer, result.crossWebThroughput);
+  AppendValue (buffer, result.webTransfers);
+  AppendValue (buffer, result.webFctP99);
+  AppendValue (buffer, result.agentFairness);
+  return buffer;
 }
 
 
-// Initialise parameters
-void SimulatorApp::Setup (Ptr<Socket> socket, Address address, uint32_t packetSize, uint32_t nPackets, DataRate dataRate)
+bool DeserializeResult (const string &buffer, SweepResult &result)
 {
-  m_socket = socket;
-  m_peer = address;
-  m_packetSize = packetSize;
-  m_nPackets = nPackets;
-  m_dataRate = dataRate;
+  size_t offset = 0;
+  return ExtractValue (buffer, offset, result.segmentSize)
+         && ExtractValue (buffer, offset, result.throughput)
+         && ExtractValue (buffer, offset, result.fairness)
+         && ExtractValue (buffer, offset, result.goodput)
+         && ExtractVector (buffer, offset, result.flowMetrics)
+         && ExtractVector (buffer, offset, result.flowThroughputs)
+         && ExtractVector (buffer, offset, result.sinkStats)
+         && ExtractString (buffer, offset, result.flowRecords)
+         && ExtractValue (buffer, offset, result.events)
+         && ExtractValue (buffer, offset, result.wallSeconds)
+         && ExtractValue (buffer, offset, result.setupSeconds)
+         && ExtractValue (buffer, offset, result.routingSeconds)
+         && ExtractValue (buffer, offset, result.traceSamples)
+         && ExtractValue (buffer, offset, result.rejectedPackets)
+         && ExtractValue (buffer, offset, result.heapAllocations)
+         && ExtractValue (buffer, offset, result.simulatedSeconds)
+         && ExtractValue (buffer, offset, result.peakRssKb)
+         && ExtractValue (buffer, offset, result.stopReason)
+         && ExtractValue (buffer, offset, result.run)
+         && ExtractValue (buffer, offset, result.queueDelayMean)
+         && ExtractValue (buffer, offset, result.queueDelayMax)
+         && ExtractValue (buffer, offset, result.queueBytesMean)
+         && ExtractValue (buffer, offset, result.transfersStarted)
+         && ExtractValue (buffer, offset, result.transfersCompleted)
+         && ExtractValue (buffer, offset, result.fctP50)
+         && ExtractValue (buffer, offset, result.fctP99)
+         && ExtractValue (buffer, offset, result.fctP999)
+         && ExtractValue (buffer, offset, result.slowdownMean)
+         && ExtractValue (buffer, offset, result.slowdownP99)
+         && ExtractValue (buffer, offset, result.delayPercentiles)
+         && ExtractValue (buffer, offset, result.jitterPercentiles)
+         && ExtractValue (buffer, offset, result.crossUdpThroughput)
+         && ExtractValue (buffer, offset, result.crossTcpThroughput)
+         && ExtractValue (buffer, offset, result.crossWebThroughput)
+         && ExtractValue (buffer, offset, result.webTransfers)
+         && ExtractValue (buffer, offset, result.webFctP99)
+         && ExtractValue (buffer, offset, result.agentFairness)
+         && offset == buffer.size ();
 }
 
 
-//Start Application
-void SimulatorApp::StartApplication (void)
+// Everything that determines the outcome of one sweep point, one "name=value" per line.
+// Its hash names the cache entry; the text itself is stored with the entry and compared on load.
+string CacheKeyText (const SweepConfig &config, int segment_size)
 {
-  m_running = true;
-  m_packetsSent = 0;
-  if (InetSocketAddress::IsMatchingType (m_peer))
+  ostringstream key;
+  // every double round-trips, so configs that differ in any bit never share a key
+  key << setprecision (17);
+  key << "program=wired\n"
+      << "binary=" << config.binaryHash << "\n"
+      << "agent=" << config.agent << "\n"
+      << "flows=" << config.flows << "\n"
+      << "topology=" << config.topology;
+  if (config.topology == "leafspine")
+    {
+      key << "/" << config.spines << "/" << config.leaves << "/" << config.hostsPerLeaf;
+    }
+  else if (config.topology == "fattree")
     {
-      m_socket->Bind ();
+      key << "/" << config.fatTreeK;
+    }
+  key << "\n"
+      << "ecmp=" << config.ecmp << "\n"
+      << "segment_size=" << segment_size << "\n"
+      << "access_link=" << config.accessRate << "/" << config.accessDelay
+      << "/" << QueueLimit (config.accessRate, config.accessDelay, segment_size, config.queueBytes) << "\n"
+      << "bottleneck_link=" << config.bottleneckRate << "/" << config.bottleneckDelay
+      << "/" << QueueLimit (config.bottleneckRate, config.bottleneckDelay, segment_size, config.queueBytes) << "\n"
+      << "app=" << config.appRate << "/" << config.packetsPerFlow << "\n"
+      << "cross=" << config.crossUdpLoad << "/" << config.crossWebLoad << "/" << config.webMeanBytes << "/" << config.crossTcp
+      << "/" << config.crossAgent << "/" << config.crossDelay << "\n"
+      << "workload=";
+  if (config.ftp)
+    {
+      key << "ftp/" << config.ftpSizes << "/" << config.ftpMeanBytes << "/" << config.ftpArrivalRate
+          << "/" << config.ftpTransfers << "\n";
     }
   else
     {
-      m_socket->Bind6 ();
+      key << "cbr\n";
+    }
+  key << "send_mode=" << (config.bulkSend ? "bulk" : "paced") << "\n"
+      << "reuse_payload=" << config.reusePayload << "\n"
+      << "scheduler=" << config.scheduler << "\n"
+      << "qdisc=" << config.qdisc << "\n"
+      << "routing=" << config.routing << "\n"
+      << "delay_bin=" << config.delayBinWidth << "\n"
+      << "measure=" << (config.sinkMeasure ? "sink" : "flowmon") << "\n"
+      << "converge=";
+  if (config.converge)
+    {
+      key << config.convergeInterval << "/" << config.convergeWindow << "/" << config.convergeTolerance << "\n";
     }
-  m_socket->Connect (m_peer);
-  SendPacket ();
+  else
+    {
+      key << "off\n";
+    }
+  key << "seed=" << config.seed << "\n"
+      << "run=" << config.run << "\n";
+  return key.str ();
 }
 
 
-//Stop Application
-void SimulatorApp::StopApplication (void)
+// Routes a network through a neighbour, out of the interface of `device`
+void AddNetworkRoute (Ptr<NetDevice> device, Ipv4Address network, Ipv4Mask mask, Ipv4Address nextHop)
 {
-  m_running = false;
+  Ptr<Ipv4> ipv4 = device->GetNode ()->GetObject<Ipv4> ();
+  Ipv4StaticRoutingHelper staticRouting;
+  staticRouting.GetStaticRouting (ipv4)->AddNetworkRouteTo (network, mask, nextHop, ipv4->GetInterfaceForDevice (device));
+}
+
 
-  if (m_sendEvent.IsRunning ())
+// Routes one address through a neighbour, out of the interface of `device`
+void AddHostRoute (Ptr<NetDevice> device, Ipv4Address destination, Ipv4Address nextHop)
+{
+  Ptr<Ipv4> ipv4 = device->GetNode ()->GetObject<Ipv4> ();
+  Ipv4StaticRoutingHelper staticRouting;
+  staticRouting.GetStaticRouting (ipv4)->AddHostRouteTo (destination, nextHop, ipv4->GetInterfaceForDevice (device));
+}
+
+
+// A static route to one host, added once the topology is built
+struct HostRoute
+{
+  Ptr<NetDevice> device;             // leaves the node through this device
+  Ipv4Address destination;
+  Ipv4Address nextHop;
+};
+
+
+// MacRx trace sink counting the packets that cross a link
+void RecordLinkRx (SinkStats *stats, Ptr<const Packet> packet)
+{
+  RecordSinkRx (stats, packet, Address ());
+}
+
+
+// Logical process owning a host of the dumbbell. The routers sit on the first and last
+// rank, so every rank boundary is a point-to-point link with a non-zero delay (lookahead).
+uint32_t SenderSystemId (const SweepConfig &config, uint32_t flow)
+{
+  return flow % config.systemCount;
+}
+
+
+uint32_t ReceiverSystemId (const SweepConfig &config, uint32_t flow)
+{
+  return config.systemCount - 1 - flow % config.systemCount;
+}
+
+
+// Sums the per-flow sink counters of all logical processes on rank 0;
+// each flow's counters are only non-zero on the rank owning its receiver
+void ReduceSinkStats (vector<SinkStats> &stats)
+{
+#ifdef NS3_MPI
+  size_t n = stats.size ();
+  vector<uint64_t> bytes (n), reducedBytes (n);
+  vector<int64_t> first (n), reducedFirst (n), last (n), reducedLast (n);
+  for (size_t i = 0; i < n; i++)
+    {
+      bytes[i] = stats[i].rxBytes;
+      first[i] = stats[i].rxBytes > 0 ? stats[i].firstRxNs : INT64_MAX;
+      last[i] = stats[i].rxBytes > 0 ? stats[i].lastRxNs : 0;
+    }
+  MPI_Reduce (bytes.data (), reducedBytes.data (), n, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce (first.data (), reducedFirst.data (), n, MPI_INT64_T, MPI_MIN, 0, MPI_COMM_WORLD);
+  MPI_Reduce (last.data (), reducedLast.data (), n, MPI_INT64_T, MPI_MAX, 0, MPI_COMM_WORLD);
+  for (size_t i = 0; i < n; i++)
     {
-      Simulator::Cancel (m_sendEvent);
+      stats[i].rxBytes = reducedBytes[i];
+      stats[i].firstRxNs = reducedBytes[i] > 0 ? reducedFirst[i] : 0;
+      stats[i].lastRxNs = reducedLast[i];
     }
+#endif
+}
+
 
-  if (m_socket)
+// Size of a generated fabric
+struct FabricShape
+{
+  uint32_t hosts;
+  uint32_t switches;
+  uint32_t links;
+  uint32_t hops;                     // switch to switch links between a flow's two hosts
+};
+
+
+FabricShape GetFabricShape (const SweepConfig &config)
+{
+  if (config.topology == "leafspine")
     {
-      m_socket->Close ();
+      uint32_t hosts = config.leaves * config.hostsPerLeaf;
+      return FabricShape {hosts, config.spines + config.leaves, hosts + config.spines * config.leaves, 2};
     }
+  // k pods of k/2 aggregation and k/2 edge switches, (k/2)^2 core switches; every layer
+  // of links has k^3/4 of them
+  uint32_t k = config.fatTreeK;
+  return FabricShape {k * k * k / 4, k * k + k * k / 4, 3 * k * k * k / 4, 4};
 }
 
 
-// Scheduling and sending packets
-void SimulatorApp::SendPacket (void)
+string DescribeFabric (const SweepConfig &config)
 {
-  Ptr<Packet> packet = Create<Packet> (m_packetSize);
-  m_socket->Send (packet);
+  FabricShape shape = GetFabricShape (config);
+  string name = config.topology == "leafspine"
+                ? "leaf-spine " + to_string (config.spines) + " spines x " + to_string (config.leaves) + " leaves"
+                : "fat-tree k=" + to_string (config.fatTreeK);
+  string routes = config.routing == "static" ? ", static up/down routes" : config.routing == "global" && config.ecmp ? ", per-packet ECMP" : "";
+  return name + ", " + to_string (shape.hosts) + " hosts, " + to_string (shape.switches) + " switches, "
+         + to_string (shape.links) + " links" + routes;
+}
+
+
+// A link of a generated fabric; the end nearer the hosts comes first
+struct FabricLink
+{
+  NetDeviceContainer devices;
+  Ipv4InterfaceContainer interfaces;
+};
+
+
+// Connects two nodes with a point-to-point link in the next /30 of `addresses`
+FabricLink ConnectNodes (PointToPointHelper &link, Ipv4AddressHelper &addresses, Ptr<Node> a, Ptr<Node> b)
+{
+  FabricLink fabricLink;
+  fabricLink.devices = link.Install (a, b);
+  fabricLink.interfaces = addresses.Assign (fabricLink.devices);
+  addresses.NewNetwork ();
+  return fabricLink;
+}
+
+
+// Static route to `destination` over a fabric link: up it from the end nearer the hosts,
+// or down it from the other end
+void RouteOver (const FabricLink &link, bool up, Ipv4Address destination, vector<HostRoute> &hostRoutes)
+{
+  uint32_t from = up ? 0 : 1;
+  hostRoutes.push_back (HostRoute {link.devices.Get (from), destination, link.interfaces.GetAddress (1 - from)});
+}
+
+
+// Builds a leaf-spine or fat-tree fabric in place of the dumbbell. Every link gets its own
+// /30 out of 10.0.0.0/8; host links run at the access rate and delay, switch to switch
+// links at the bottleneck ones. Flow i goes from host i to host i + hosts/2, which hangs
+// off another leaf (in a fat tree, another pod), so every flow crosses the fabric.
+// With static routing, the hosts default to their edge switch and every switch gets a
+// host route to every host it does not reach directly: down towards it when the host is
+// below the switch, otherwise up a link picked by the host's index, which spreads the
+// destinations over the uplinks the way ECMP would spread flows.
+void BuildFabric (const SweepConfig &config, int segment_size, InternetStackHelper &stack,
+                  NodeContainer &senders, NodeContainer &receivers, vector<Ipv4Address> &receiverAddresses,
+                  vector<pair<Ptr<NetDevice>, Ipv4Address> > &defaultRoutes, vector<HostRoute> &hostRoutes)
+{
+  PointToPointHelper hostLink;
+  hostLink.SetDeviceAttribute ("DataRate", StringValue (config.accessRate));
+  hostLink.SetChannelAttribute ("Delay", StringValue (config.accessDelay));
+  hostLink.SetQueue ("ns3::DropTailQueue<Packet>", "MaxSize", StringValue (QueueLimit (config.accessRate, config.accessDelay, segment_size, config.queueBytes)));
+
+  PointToPointHelper fabricLink;
+  fabricLink.SetDeviceAttribute ("DataRate", StringValue (config.bottleneckRate));
+  fabricLink.SetChannelAttribute ("Delay", StringValue (config.bottleneckDelay));
+  fabricLink.SetQueue ("ns3::DropTailQueue<Packet>", "MaxSize", StringValue (QueueLimit (config.bottleneckRate, config.bottleneckDelay, segment_size, config.queueBytes)));
+
+  FabricShape shape = GetFabricShape (config);
+  NodeContainer hosts, switches;
+  hosts.Create (shape.hosts);
+  switches.Create (shape.switches);
+  stack.Install (hosts);
+  stack.Install (switches);
+
+  Ipv4AddressHelper addresses;
+  addresses.SetBase ("10.0.0.0", "255.255.255.252");
+
+  // the edge switches (leaves) come last, so that host h hangs off switch edgeBase + h / hostsPerEdge.
+  // Switch to switch links are kept by their (lower, upper) switch indices.
+  map<pair<uint32_t, uint32_t>, FabricLink> links;
+  uint32_t edgeBase, hostsPerEdge;
+  if (config.topology == "leafspine")
+    {
+      // spines, then leaves; every leaf connects to every spine
+      edgeBase = config.spines;
+      hostsPerEdge = config.hostsPerLeaf;
+      for (uint32_t leaf = 0; leaf < config.leaves; leaf++)
+        {
+          for (uint32_t spine = 0; spine < config.spines; spine++)
+            {
+              links[make_pair (edgeBase + leaf, spine)] = ConnectNodes (fabricLink, addresses, switches.Get (edgeBase + leaf), switches.Get (spine));
+            }
+        }
+    }
+  else
+    {
+      // cores, then the aggregation switches pod by pod, then the edge switches pod by pod.
+      // Aggregation switch a of every pod connects to cores a*k/2 .. a*k/2 + k/2 - 1.
+      uint32_t half = config.fatTreeK / 2;
+      uint32_t cores = half * half;
+      edgeBase = cores + config.fatTreeK * half;
+      hostsPerEdge = half;
+      for (uint32_t pod = 0; pod < config.fatTreeK; pod++)
+        {
+          for (uint32_t a = 0; a < half; a++)
+            {
+              Ptr<Node> aggregation = switches.Get (cores + pod * half + a);
+              for (uint32_t c = 0; c < half; c++)
+                {
+                  links[make_pair (cores + pod * half + a, a * half + c)] = ConnectNodes (fabricLink, addresses, aggregation, switches.Get (a * half + c));
+                }
+              for (uint32_t e = 0; e < half; e++)
+                {
+                  links[make_pair (edgeBase + pod * half + e, cores + pod * half + a)] = ConnectNodes (fabricLink, addresses, switches.Get (edgeBase + pod * half + e), aggregation);
+                }
+            }
+        }
+    }
+
+  vector<Ipv4Address> hostAddresses;
+  for (uint32_t h = 0; h < shape.hosts; h++)
+    {
+      FabricLink link = ConnectNodes (hostLink, addresses, hosts.Get (h), switches.Get (edgeBase + h / hostsPerEdge));
+      hostAddresses.push_back (link.interfaces.GetAddress (0));
+      defaultRoutes.push_back (make_pair (link.devices.Get (0), link.interfaces.GetAddress (1)));
+    }
 
-  if (++m_packetsSent < m_nPackets)
+  // the edge switch of a host reaches it over their /30 already
+  for (uint32_t h = 0; config.routing == "static" && h < shape.hosts; h++)
     {
-      ScheduleTx ();
+      uint32_t edge = h / hostsPerEdge;
+      if (config.topology == "leafspine")
+        {
+          for (uint32_t spine = 0; spine < config.spines; spine++)
+            {
+              RouteOver (links[make_pair (edgeBase + edge, spine)], false, hostAddresses[h], hostRoutes);
+            }
+          for (uint32_t leaf = 0; leaf < config.leaves; leaf++)
+            {
+              if (leaf != edge)
+                {
+                  RouteOver (links[make_pair (edgeBase + leaf, h % config.spines)], true, hostAddresses[h], hostRoutes);
+                }
+            }
+          continue;
+        }
+      // up through aggregation switch h % k/2 of the pod and core (h / (k/2)) % k/2 of its group
+      uint32_t half = config.fatTreeK / 2;
+      uint32_t cores = half * half;
+      uint32_t pod = edge / half;
+      uint32_t upAggregation = h % half;
+      uint32_t upCore = (h / half) % half;
+      for (uint32_t e = 0; e < config.fatTreeK * half; e++)
+        {
+          if (e != edge)
+            {
+              RouteOver (links[make_pair (edgeBase + e, cores + (e / half) * half + upAggregation)], true, hostAddresses[h], hostRoutes);
+            }
+        }
+      for (uint32_t p = 0; p < config.fatTreeK; p++)
+        {
+          for (uint32_t a = 0; a < half; a++)
+            {
+              if (p == pod)
+                {
+                  RouteOver (links[make_pair (edgeBase + edge, cores + p * half + a)], false, hostAddresses[h], hostRoutes);
+                }
+              else
+                {
+                  RouteOver (links[make_pair (cores + p * half + a, a * half + upCore)], true, hostAddresses[h], hostRoutes);
+                }
+            }
+        }
+      for (uint32_t a = 0; a < half; a++)
+        {
+          for (uint32_t c = 0; c < half; c++)
+            {
+              RouteOver (links[make_pair (cores + pod * half + a, a * half + c)], false, hostAddresses[h], hostRoutes);
+            }
+        }
+    }
+
+  for (uint32_t i = 0; i < config.flows; i++)
+    {
+      senders.Add (hosts.Get (i));
+      receivers.Add (hosts.Get (i + shape.hosts / 2));
+      receiverAddresses.push_back (hostAddresses[i + shape.hosts / 2]);
     }
 }
 
 
-// Packet Scheduler
-void SimulatorApp::ScheduleTx (void)
+// Runs a single (agent, segment size) point of the sweep on an N-flow dumbbell:
+// every sender reaches its own receiver across the shared RouterToRouter bottleneck
+SweepResult RunSweepPoint (const SweepConfig &config, int segment_size)
 {
-  if (m_running)
+	auto setupStart = chrono::steady_clock::now ();
+	ResetPeakRss ();
+	RngSeedManager::SetSeed (config.seed);
+	RngSeedManager::SetRun (config.run);
+	
+	//selecting the event scheduler
+	ObjectFactory schedulerFactory;
+	schedulerFactory.SetTypeId (SchedulerTypeName (config.scheduler));
+	Simulator::SetScheduler (schedulerFactory);
+	
+	//setting segment size
+	Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (segment_size));
+	Config::SetDefault ("ns3::Ipv4GlobalRouting::RandomEcmpRouting", BooleanValue (config.ecmp));
+	
+	NodeContainer routers, senders, receivers;
+	vector<Ipv4Address> receiverAddresses;
+	vector<pair<Ptr<NetDevice>, Ipv4Address> > defaultRoutes;
+	vector<HostRoute> hostRoutes;
+	unique_ptr<QueueMonitor> queueMonitor;
+	unique_ptr<CrossTraffic> crossTraffic;
+	InternetStackHelper stack;
+	Ipv4NixVectorHelper nixRouting;
+	Ipv4StaticRoutingHelper staticRouting;
+	if(config.routing=="nix")
+		stack.SetRoutingHelper (nixRouting);
+	else if(config.routing=="static")
+		stack.SetRoutingHelper (staticRouting);
+	
+	if(config.topology!="dumbbell")
+		BuildFabric (config, segment_size, stack, senders, receivers, receiverAddresses, defaultRoutes, hostRoutes);
+	else
+	{
+		//creating nodes, each owned by one logical process (all 0 unless distributed)
+		routers.Add (CreateObject<Node> (0));
+		routers.Add (CreateObject<Node> (config.systemCount-1));
+		for(uint32_t i=0;i<config.flows;i++)
+		{
+			senders.Add (CreateObject<Node> (SenderSystemId (config, i)));
+			receivers.Add (CreateObject<Node> (ReceiverSystemId (config, i)));
+		}
+		
+		//creating links
+		PointToPointHelper HostToRouter;
+		HostToRouter.SetDeviceAttribute ("DataRate", StringValue (config.accessRate));
+		HostToRouter.SetChannelAttribute ("Delay", StringValue (config.accessDelay));
+		HostToRouter.SetQueue("ns3::DropTailQueue<Packet>", "MaxSize", StringValue(QueueLimit (config.accessRate, config.accessDelay, segment_size, config.queueBytes)));
+		
+		PointToPointHelper RouterToRouter;
+		RouterToRouter.SetDeviceAttribute ("DataRate", StringValue (config.bottleneckRate));
+		RouterToRouter.SetChannelAttribute ("Delay", StringValue (config.bottleneckDelay));
+		//with a queue disc the device queue is kept to one packet, so that the queue builds up in the queue disc
+		string bottleneckLimit = QueueLimit (config.bottleneckRate, config.bottleneckDelay, segment_size, config.queueBytes);
+		string qdiscType = QueueDiscTypeName (config.qdisc);
+		RouterToRouter.SetQueue("ns3::DropTailQueue<Packet>", "MaxSize", StringValue(qdiscType.empty() ? bottleneckLimit : "1p"));
+		
+		//building Internet stack; with static routing the dumbbell's routes are known as it is
+		//built: every node's default route points towards the other side of the bottleneck
+		stack.Install(routers);
+		stack.Install(senders);
+		stack.Install(receivers);
+		
+		//setting up the bottleneck between the routers
+		NetDeviceContainer R1R2 = RouterToRouter.Install( routers.Get(0), routers.Get(1));
+		Ipv4AddressHelper ipv4_R1R2;
+		ipv4_R1R2.SetBase( "10.1.2.0" , "255.255.255.0" );
+		Ipv4InterfaceContainer R1R2Interface = ipv4_R1R2.Assign ( R1R2 );
+		defaultRoutes.push_back (make_pair (R1R2.Get (0), R1R2Interface.GetAddress (1)));
+		defaultRoutes.push_back (make_pair (R1R2.Get (1), R1R2Interface.GetAddress (0)));
+		
+		//replacing the queue disc the address helper installed on the router interfaces
+		TrafficControlHelper trafficControl;
+		QueueDiscContainer bottleneckQueueDiscs;
+		if(config.qdisc!="default")
+			trafficControl.Uninstall (R1R2);
+		if(!qdiscType.empty())
+		{
+			trafficControl.SetRootQueueDisc (qdiscType, "MaxSize", QueueSizeValue (QueueSize (bottleneckLimit)));
+			bottleneckQueueDiscs = trafficControl.Install (R1R2);
+		}
+		
+		//tracing the queue the data leaves the first router through
+		if(config.systemId==0)
+		{
+			queueMonitor.reset (new QueueMonitor (config.queueTrace ? "wired_TCP_"+config.agent+"_"+to_string(segment_size)+".queue" : "", config.traceBuffer));
+			if(!qdiscType.empty())
+				queueMonitor->WatchQueueDisc (bottleneckQueueDiscs.Get (0));
+			else
+				queueMonitor->WatchDeviceQueue (DynamicCast<PointToPointNetDevice> (R1R2.Get (0))->GetQueue ());
+		}
+		
+		//setting up one access link per host, each in its own /30 subnet
+		Ipv4AddressHelper ipv4_Senders;
+		ipv4_Senders.SetBase( "10.2.0.0" , "255.255.255.252" );
+		Ipv4AddressHelper ipv4_Receivers;
+		ipv4_Receivers.SetBase( "10.3.0.0" , "255.255.255.252" );
+		
+		for(uint32_t i=0;i<config.flows;i++)
+		{
+			NetDeviceContainer SenderR1 = HostToRouter.Install( senders.Get(i), routers.Get(0));
+			Ipv4InterfaceContainer SenderR1Interface = ipv4_Senders.Assign ( SenderR1 );
+			ipv4_Senders.NewNetwork ();
+			defaultRoutes.push_back (make_pair (SenderR1.Get (0), SenderR1Interface.GetAddress (1)));
+		
+			NetDeviceContainer R2Receiver = HostToRouter.Install( routers.Get(1), receivers.Get(i));
+			Ipv4InterfaceContainer R2ReceiverInterface = ipv4_Receivers.Assign ( R2Receiver );
+			ipv4_Receivers.NewNetwork ();
+			defaultRoutes.push_back (make_pair (R2Receiver.Get (1), R2ReceiverInterface.GetAddress (0)));
+			receiverAddresses.push_back (R2ReceiverInterface.GetAddress (1));
+		}
+		
+		//cross traffic across the bottleneck, from hosts of its own
+		if(HasCrossTraffic (config))
+		{
+			double baseRtt = 2*(2*Time (config.crossDelay).GetSeconds ()+Time (config.bottleneckDelay).GetSeconds ());
+			crossTraffic.reset (new CrossTraffic (config, DataRate (config.bottleneckRate).GetBitRate (), Seconds (baseRtt)));
+			crossTraffic->Install (routers.Get (0), routers.Get (1), stack, "10.4.0.0", "255.255.255.252", defaultRoutes);
+		}
+	}
+	
+	//Assigning port Number;
+	uint16_t sinkPort = 9898;
+	Address anyAddress = InetSocketAddress (Ipv4Address::GetAny (), sinkPort);
+	
+	//Creating application container; in a distributed run each rank only installs
+	//applications on the nodes it owns
+	PacketSinkHelper packetSinkHelper ("ns3::TcpSocketFactory", anyAddress);
+	vector<SinkStats> sinkStats (config.flows, SinkStats {0, 0, 0});
+	//file transfers are timed against an ideal one at the base RTT and the slowest link's rate
+	unique_ptr<TransferTracker> transferTracker;
+	if(config.ftp)
+	{
+		double idealRate = min (DataRate (config.accessRate).GetBitRate (), DataRate (config.bottleneckRate).GetBitRate ());
+		uint32_t hops = config.topology=="dumbbell" ? 1 : GetFabricShape (config).hops;
+		double baseRtt = 2*(2*Time (config.accessDelay).GetSeconds ()+hops*Time (config.bottleneckDelay).GetSeconds ());
+		transferTracker.reset (new TransferTracker (idealRate, Seconds (baseRtt)));
+	}
+	
+	unique_ptr<TimeSeriesSampler> sampler;
+	if(config.trace)
+		sampler.reset (new TimeSeriesSampler ("wired_TCP_"+config.agent+"_"+to_string(segment_size)+".ts", config.flows, Seconds (config.traceInterval), config.traceBuffer));
+	unique_ptr<ConvergenceMonitor> monitor;
+	if(config.converge)
+		monitor.reset (new ConvergenceMonitor (Seconds (config.convergeInterval), config.convergeWindow, config.convergeTolerance));
+	
+	for(uint32_t i=0;i<config.flows;i++)
+	{
+		if(ReceiverSystemId (config, i)!=config.systemId)
+			continue;
+		
+		ApplicationContainer sinkApps = packetSinkHelper.Install (receivers.Get (i));
+		sinkApps.Get (0)->TraceConnectWithoutContext ("Rx", MakeBoundCallback (&RecordSinkRx, &sinkStats[i]));
+		if(sampler)
+			sampler->WatchSink (i, sinkApps.Get (0));
+		if(monitor)
+			monitor->WatchSink (sinkApps.Get (0));
+		if(transferTracker)
+			transferTracker->WatchSink (sinkApps.Get (0));
+		//Set the start and stop times for the server-side
+		sinkApps.Start (Seconds (0.));
+		sinkApps.Stop (Seconds (20.));
+	}
+	
+	vector<Ptr<SimulatorApp> > senderApps;
+	for(uint32_t i=0;i<config.flows;i++)
+	{
+		if(SenderSystemId (config, i)!=config.systemId)
+			continue;
+		
+		Address sinkAddress = InetSocketAddress (receiverAddresses[i], sinkPort);
+		
+		if(config.ftp)
+		{
+			Ptr<FileTransferApp> ftpApp = CreateObject<FileTransferApp> ();
+			ftpApp->Setup (sinkAddress, transferTracker.get (), FileSizeStream (config), TransferGapStream (config), config.ftpTransfers);
+			senders.Get(i)->AddApplication(ftpApp);
+			ftpApp->SetStartTime (Seconds (1.));
+			ftpApp->SetStopTime (Seconds (20.));
+			continue;
+		}
+		
+		// Create a client socket
+		Ptr<Socket> ns3TcpSocket = Socket::CreateSocket (senders.Get (i), TcpSocketFactory::GetTypeId ());
+		if(sampler)
+			sampler->WatchSender (i, ns3TcpSocket);
+		//Create an Application
+		Ptr<SimulatorApp> simulApp = CreateObject<SimulatorApp> ();
+		simulApp->Setup(ns3TcpSocket, sinkAddress, segment_size, config.packetsPerFlow, DataRate (config.appRate), config.bulkSend);
+		simulApp->SetPayloadReuse (config.reusePayload);
+		senders.Get(i)->AddApplication(simulApp);
+		senderApps.push_back (simulApp);
+		if(monitor)
+			monitor->WatchSender (simulApp);
+		//Set the start and stop times for the client-side
+		simulApp->SetStartTime (Seconds (1.));
+		simulApp->SetStopTime (Seconds (20.));
+	}
+	
+	//populating routing tables: global routing runs SPF from every node, nix-vector routing
+	//computes a path per destination on first use (during the run)
+	auto routingStart = chrono::steady_clock::now ();
+	if(config.routing=="global")
+		Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+	else if(config.routing=="static")
+	{
+		for(size_t i=0;i<defaultRoutes.size();i++)
+			AddDefaultRoute (defaultRoutes[i].first, defaultRoutes[i].second);
+		for(size_t i=0;i<hostRoutes.size();i++)
+			AddHostRoute (hostRoutes[i].device, hostRoutes[i].destination, hostRoutes[i].nextHop);
+	}
+	double routingSeconds = chrono::duration<double> (chrono::steady_clock::now () - routingStart).count ();
+	
+	//Flow monitor; its packet tracking does not span logical processes, so a distributed
+	//run measures at the sinks only. The sink measurement mode puts constant-memory
+	//counters on the hosts instead.
+	Ptr<FlowMonitor> flowMonitor;
+	FlowMonitorHelper flowHelper;
+	DelaySketch delaySketch, jitterSketch;
+	vector<FlowMeter> flowMeters;
+	if(config.sinkMeasure)
+	{
+		flowMeters.assign (config.flows, FlowMeter (&delaySketch, &jitterSketch));
+		for(uint32_t i=0;i<config.flows;i++)
+		{
+			flowMeters[i].WatchSender (senders.Get (i));
+			flowMeters[i].WatchReceiver (receivers.Get (i));
+		}
+	}
+	else if(!config.distributed)
+	{
+		flowHelper.SetMonitorAttribute ("DelayBinWidth", DoubleValue (config.delayBinWidth));
+		flowHelper.SetMonitorAttribute ("JitterBinWidth", DoubleValue (config.delayBinWidth));
+		flowMonitor = flowHelper.InstallAll();
+	}
+	
+	if(sampler)
+		sampler->Start (Seconds (0.));
+	if(monitor)
+		monitor->Start (Seconds (0.));
+	
+	Simulator::Stop (Seconds (20));
+	auto wallStart = chrono::steady_clock::now ();
+	double setupSeconds = chrono::duration<double> (wallStart - setupStart).count ();
+	uint64_t allocationsBefore = g_heapAllocations.load (memory_order_relaxed);
+	Simulator::Run ();
+	uint64_t heapAllocations = g_heapAllocations.load (memory_order_relaxed) - allocationsBefore;
+	double simulatedSeconds = Simulator::Now ().GetSeconds ();
+	uint64_t traceSamples = sampler ? sampler->Finish () : 0;
+	if(queueMonitor)
+		queueMonitor->Finish ();
+	double wallSeconds = chrono::duration<double> (chrono::steady_clock::now () - wallStart).count ();
+	
+	vector<double> flowThroughputs;
+	double delayPercentiles[4]={0, 0, 0, 0}, jitterPercentiles[4]={0, 0, 0, 0};
+	vector<FlowMetrics> flowMetrics (config.flows, FlowMetrics ());
+	for(uint32_t i=0;i<config.flows;i++)
+		flowMetrics[i].flow = i;
+	string flowRecords;
+	if(config.distributed)
+	{
+		//only the sinks are measured: the goodput stands in for the throughput
+		ReduceSinkStats (sinkStats);
+		for(size_t i=0;i<sinkStats.size();i++)
+		{
+			double totData = 8.0 * sinkStats[i].rxBytes;
+			double totTime = (sinkStats[i].lastRxNs-sinkStats[i].firstRxNs)/1e9;
+			
+			flowMetrics[i].goodput = totTime>0 ? totData/(1000*totTime) : 0;
+			flowThroughputs.push_back (flowMetrics[i].goodput);
+		}
+	}
+	else if(config.sinkMeasure)
+	{
+		for(uint32_t i=0;i<config.flows;i++)
+		{
+			flowMeters[i].Record (flowMetrics[i], sinkStats[i].rxBytes);
+			flowThroughputs.push_back (flowMetrics[i].throughput);
+		}
+		for(int q=0;q<4;q++)
+		{
+			delayPercentiles[q] = delaySketch.Quantile (LATENCY_QUANTILES[q]);
+			jitterPercentiles[q] = jitterSketch.Quantile (LATENCY_QUANTILES[q]);
+		}
+	}
+	else
+	{
+		// Output the data in xml format
+		if(config.writeXml)
+			flowMonitor->SerializeToXmlFile("wired_TCP_"+config.agent+"_"+std::to_string(segment_size)+".xml", true, true);
+		
+		//Obtaining per-flow statistics: data flows go to a sink, ACK flows come back from it;
+		//the receiver address tells which sender/receiver pair a flow belongs to
+		Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier> (flowHelper.GetClassifier ());
+		flowRecords = EncodeFlowRecords (config.agent, segment_size, flowMonitor, classifier);
+		vector<uint64_t> delayBins, jitterBins;
+		map<uint32_t, uint32_t> flowOfReceiver;
+		for(uint32_t i=0;i<config.flows;i++)
+			flowOfReceiver[receiverAddresses[i].Get ()] = i;
+		for(auto statistics=flowMonitor->GetFlowStats().begin();statistics!=flowMonitor->GetFlowStats().end();statistics++)
+		{
+			Ipv4FlowClassifier::FiveTuple tuple = classifier->FindFlow (statistics->first);
+			if(tuple.destinationPort==sinkPort)
+			{
+				AddHistogram (delayBins, statistics->second.delayHistogram);
+				AddHistogram (jitterBins, statistics->second.jitterHistogram);
+				auto receiver = flowOfReceiver.find (tuple.destinationAddress.Get ());
+				if(receiver!=flowOfReceiver.end())
+					RecordDataFlow (flowMetrics[receiver->second], statistics->second, sinkStats[receiver->second].rxBytes);
+			}
+			else if(tuple.sourcePort==sinkPort)
+			{
+				auto receiver = flowOfReceiver.find (tuple.sourceAddress.Get ());
+				if(receiver!=flowOfReceiver.end())
+					RecordAckFlow (flowMetrics[receiver->second], statistics->second);
+			}
+		}
+		for(uint32_t i=0;i<config.flows;i++)
+			flowThroughputs.push_back (flowMetrics[i].throughput);
+		
+		//tail latency of the data over all flows
+		for(int q=0;q<4;q++)
+		{
+			delayPercentiles[q] = HistogramPercentile (delayBins, config.delayBinWidth, LATENCY_QUANTILES[q]);
+			jitterPercentiles[q] = HistogramPercentile (jitterBins, config.delayBinWidth, LATENCY_QUANTILES[q]);
+		}
+	}
+	
+	double sumThroughput=0;
+	double sumSqThroughput=0;
+	int n=0;
+	
+	for(size_t i=0;i<flowThroughputs.size();i++)
+	{
+		sumThroughput += flowThroughputs[i];
+		sumSqThroughput += flowThroughputs[i]*flowThroughputs[i];
+		n++;
+	}
+	
+	double goodput=0;
+	for(size_t i=0;i<flowMetrics.size();i++)
+		goodput += flowMetrics[i].goodput;
+	
+	double jain_fairness = sumSqThroughput>0 ? (sumThroughput*sumThroughput)/((n+0.0)*sumSqThroughput) : 0;
+	uint64_t events = Simulator::GetEventCount ();
+	uint64_t rejectedPackets = 0;
+	for(size_t i=0;i<senderApps.size();i++)
+		rejectedPackets += senderApps[i]->GetPacketsRejected ();
+	
+	Simulator::Destroy ();
+	
+	SweepResult result;
+	result.segmentSize = segment_size;
+	result.throughput = sumThroughput;
+	result.fairness = jain_fairness;
+	result.goodput = goodput;
+	result.flowMetrics = flowMetrics;
+	result.flowThroughputs = flowThroughputs;
+	result.sinkStats = sinkStats;
+	result.flowRecords = flowRecords;
+	result.events = events;
+	result.wallSeconds = wallSeconds;
+	result.setupSeconds = setupSeconds;
+	result.routingSeconds = routingSeconds;
+	result.traceSamples = traceSamples;
+	result.rejectedPackets = rejectedPackets;
+	result.heapAllocations = heapAllocations;
+	result.simulatedSeconds = simulatedSeconds;
+	result.peakRssKb = PeakRssKb ();
+	result.stopReason = monitor ? monitor->GetReason () : STOP_FULL_LENGTH;
+	result.run = config.run;
+	result.queueDelayMean = queueMonitor ? queueMonitor->GetMeanSojourn () : 0;
+	result.queueDelayMax = queueMonitor ? queueMonitor->GetMaxSojourn () : 0;
+	result.queueBytesMean = queueMonitor ? queueMonitor->GetMeanBytes () : 0;
+	RecordTransfers (result, transferTracker.get ());
+	memcpy (result.delayPercentiles, delayPercentiles, sizeof (delayPercentiles));
+	memcpy (result.jitterPercentiles, jitterPercentiles, sizeof (jitterPercentiles));
+	result.crossUdpThroughput = 0;
+	result.crossTcpThroughput = 0;
+	result.crossWebThroughput = 0;
+	result.webTransfers = 0;
+	result.webFctP99 = 0;
+	result.agentFairness = 0;
+	if(crossTraffic)
+	{
+		vector<double> goodputs;
+		for(size_t i=0;i<flowMetrics.size();i++)
+			goodputs.push_back (flowMetrics[i].goodput);
+		crossTraffic->Record (result, goodputs);
+	}
+	result.cached = false;
+	return result;
+}
+
+
+// Writes the per-flow sink counters of every sweep point, so that a later run
+// (e.g. a distributed one) can be compared against this one
+void WriteSinkStats (string fileName, const vector<SweepResult> &results)
+{
+  ofstream out (fileName.c_str ());
+  out << "# segment_size flow rx_bytes first_rx_ns last_rx_ns run_wall_seconds\n";
+  for (size_t i = 0; i < results.size (); i++)
+    {
+      for (size_t f = 0; f < results[i].sinkStats.size (); f++)
+        {
+          const SinkStats &stats = results[i].sinkStats[f];
+          out << results[i].segmentSize << " " << f << " " << stats.rxBytes << " " << stats.firstRxNs
+              << " " << stats.lastRxNs << " " << results[i].wallSeconds << "\n";
+        }
+    }
+}
+
+
+// Reads a file written by WriteSinkStats, keyed by segment size
+map<int, SweepResult> LoadSinkStats (string fileName)
+{
+  map<int, SweepResult> baseline;
+  ifstream in (fileName.c_str ());
+  if (!in)
+    {
+      NS_LOG_INFO ("Unable to read baseline file " + fileName);
+      exit (1);
+    }
+  string line;
+  while (getline (in, line))
     {
-      Time tNext (Seconds (m_packetSize * 8 / static_cast<double> (m_dataRate.GetBitRate ())));
-      m_sendEvent = Simulator::Schedule (tNext, &SimulatorApp::SendPacket, this);
+      if (line.empty () || line[0] == '#')
+        {
+          continue;
+        }
+      istringstream fields (line);
+      int segment_size;
+      size_t flow;
+      SinkStats stats;
+      double wallSeconds;
+      if (!(fields >> segment_size >> flow >> stats.rxBytes >> stats.firstRxNs >> stats.lastRxNs >> wallSeconds))
+        {
+          continue;
+        }
+      SweepResult &point = baseline[segment_size];
+      point.segmentSize = segment_size;
+      point.wallSeconds = wallSeconds;
+      if (point.sinkStats.size () <= flow)
+        {
+          point.sinkStats.resize (flow + 1, SinkStats {0, 0, 0});
+        }
+      point.sinkStats[flow] = stats;
     }
+  return baseline;
+}
+
+
+// Compares the run time and sink counters of every point against a baseline run. Only the
+// sink counters are compared: a distributed run has no FlowMonitor statistics to match.
+void PrintSpeedupReport (const vector<SweepResult> &results, const map<int, SweepResult> &baseline)
+{
+	NS_LOG_INFO("+----------------------------------------------------------------+");
+	NS_LOG_INFO("|Packet Size  | Baseline wall (s) |  Wall (s)  | Speedup | Sink counters |");
+	NS_LOG_INFO("+----------------------------------------------------------------+");
+	for(size_t i=0;i<results.size();i++)
+	{
+		auto reference = baseline.find (results[i].segmentSize);
+		if(reference==baseline.end())
+		{
+			NS_LOG_INFO("|    "+ to_string(results[i].segmentSize) +"     |   not in baseline");
+			continue;
+		}
+		
+		bool sameCounters = reference->second.sinkStats.size()==results[i].sinkStats.size();
+		for(size_t f=0;sameCounters && f<results[i].sinkStats.size();f++)
+		{
+			const SinkStats &a = reference->second.sinkStats[f];
+			const SinkStats &b = results[i].sinkStats[f];
+			sameCounters = a.rxBytes==b.rxBytes && a.firstRxNs==b.firstRxNs && a.lastRxNs==b.lastRxNs;
+		}
+		
+		double speedup = results[i].wallSeconds>0 ? reference->second.wallSeconds/results[i].wallSeconds : 0;
+		NS_LOG_INFO("|    "+ to_string(results[i].segmentSize) +"     |   "+ to_string(reference->second.wallSeconds) +"   |   "+ to_string(results[i].wallSeconds) +"   |   "+ to_string(speedup) +"   |   "+ (sameCounters ? "same" : "DIFFERENT") +"   |");
+	}
+	NS_LOG_INFO("+----------------------------------------------------------------+");
+}
+
+
+// Prints how the measured flows share the bottleneck with the cross traffic
+void PrintCrossTrafficReport (const SweepConfig &config, const vector<SweepResult> &results)
+{
+	NS_LOG_INFO("Cross traffic: "+ DescribeCrossTraffic (config));
+	NS_LOG_INFO("+-----------------------------------------------------------------------------------------------------------------------------------+");
+	NS_LOG_INFO("|Packet Size  |   Throughput   | p99 Delay (ms) |  UDP (Kbps)  | Competing TCP (Kbps) |  Web (Kbps)  | Inter-agent Fairness | Web p99 FCT (s) |");
+	NS_LOG_INFO("+-----------------------------------------------------------------------------------------------------------------------------------+");
+	for(size_t i=0;i<results.size();i++)
+	{
+		NS_LOG_INFO("|    "+ to_string(results[i].segmentSize) +"     |   "+ to_string(results[i].throughput) +"   |   "+ to_string(1000*results[i].delayPercentiles[2]) +"   |   "+ to_string(results[i].crossUdpThroughput)
+			+"   |   "+ to_string(results[i].crossTcpThroughput) +"   |   "+ to_string(results[i].crossWebThroughput) +"   |   "+ to_string(results[i].agentFairness) +"   |   "+ to_string(results[i].webFctP99) +"   |");
+	}
+	NS_LOG_INFO("+-----------------------------------------------------------------------------------------------------------------------------------+");
 }
 
+
+// Real-time lag of an emulation run: every interval an event compares the wall-clock time
+// since the run started with its simulation time. A probe running more than the deadline
+// late is a missed deadline.
+class LagMonitor
+{
+	public:
+		LagMonitor (Time interval, Time deadline);
+		void Start (void);
+		uint64_t GetProbes (void) const;
+		uint64_t GetMissed (void) const;
+		double GetMeanLag (void) const;
+		double GetMaxLag (void) const;
+		double GetLagQuantile (double q) const;
+
+	private:
+		void Probe (void);
+
+		Time                  m_interval;
+		double                m_deadline;
+		chrono::steady_clock::time_point m_origin;
+		DelaySketch           m_lags;
+		uint64_t              m_probes;
+		uint64_t              m_missed;
+		double                m_lagSum;
+		double                m_lagMax;
+};
+
+
+LagMonitor::LagMonitor (Time interval, Time deadline)
+  : m_interval (interval),
+    m_deadline (deadline.GetSeconds ()),
+    m_probes (0),
+    m_missed (0),
+    m_lagSum (0),
+    m_lagMax (0)
+{
+}
+
+
+// Call right before Simulator::Run (), which starts the real-time clock
+void LagMonitor::Start (void)
+{
+  m_origin = chrono::steady_clock::now ();
+  Simulator::Schedule (m_interval, &LagMonitor::Probe, this);
+}
+
+
+uint64_t LagMonitor::GetProbes (void) const
+{
+  return m_probes;
+}
+
+
+uint64_t LagMonitor::GetMissed (void) const
+{
+  return m_missed;
+}
+
+
+// Lag statistics, in seconds
+double LagMonitor::GetMeanLag (void) const
+{
+  return m_probes > 0 ? m_lagSum / m_probes : 0;
+}
+
+
+double LagMonitor::GetMaxLag (void) const
+{
+  return m_lagMax;
+}
+
+
+double LagMonitor::GetLagQuantile (double q) const
+{
+  return m_lags.Quantile (q);
+}
+
+
+void LagMonitor::Probe (void)
+{
+  double wall = chrono::duration<double> (chrono::steady_clock::now () - m_origin).count ();
+  double lag = max (0.0, wall - Simulator::Now ().GetSeconds ());
+  m_probes++;
+  m_lagSum += lag;
+  m_lagMax = max (m_lagMax, lag);
+  m_lags.Add (lag);
+  if (lag > m_deadline)
+    {
+      m_missed++;
+    }
+  Simulator::Schedule (m_interval, &LagMonitor::Probe, this);
+}
+
+
+#ifdef HAVE_FD_NET_DEVICE
+// Emulation against the kernel's TCP stack. The dumbbell's hosts are replaced by two edge
+// nodes whose FdNetDevices sit on veth interfaces (raw sockets, so this needs root), and
+// the simulator runs in real time: real sockets in two network namespaces, on 10.1.1.0/24
+// and 10.1.3.0/24 with the edges at .2, send through the simulated access links and
+// bottleneck. The data crossing the bottleneck and the real-time lag are reported.
+void RunEmulation (const SweepConfig &config, string leftDevice, string rightDevice, double seconds, double deadline)
+{
+	GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::RealtimeSimulatorImpl"));
+	GlobalValue::Bind ("ChecksumEnabled", BooleanValue (true));
+	Config::SetDefault ("ns3::RealtimeSimulatorImpl::SynchronizationMode", StringValue ("BestEffort"));
+	
+	//edge nodes facing the namespaces and the two routers; routes are static, as global
+	//routing does not know the links behind the FdNetDevices
+	NodeContainer edges, routers;
+	edges.Create (2);
+	routers.Create (2);
+	Ipv4StaticRoutingHelper staticRouting;
+	InternetStackHelper stack;
+	stack.SetRoutingHelper (staticRouting);
+	stack.Install (edges);
+	stack.Install (routers);
+	
+	EmuFdNetDeviceHelper emu;
+	emu.SetDeviceName (leftDevice);
+	NetDeviceContainer left = emu.Install (edges.Get (0));
+	emu.SetDeviceName (rightDevice);
+	NetDeviceContainer right = emu.Install (edges.Get (1));
+	Ipv4AddressHelper ipv4_Left;
+	ipv4_Left.SetBase ("10.1.1.0", "255.255.255.0", "0.0.0.2");
+	ipv4_Left.Assign (left);
+	Ipv4AddressHelper ipv4_Right;
+	ipv4_Right.SetBase ("10.1.3.0", "255.255.255.0", "0.0.0.2");
+	ipv4_Right.Assign (right);
+	
+	//the same access links and bottleneck as the simulated dumbbell, with 1500-byte packets
+	PointToPointHelper HostToRouter;
+	HostToRouter.SetDeviceAttribute ("DataRate", StringValue (config.accessRate));
+	HostToRouter.SetChannelAttribute ("Delay", StringValue (config.accessDelay));
+	HostToRouter.SetQueue("ns3::DropTailQueue<Packet>", "MaxSize", StringValue(QueueLimit (config.accessRate, config.accessDelay, 1500, config.queueBytes)));
+	
+	PointToPointHelper RouterToRouter;
+	RouterToRouter.SetDeviceAttribute ("DataRate", StringValue (config.bottleneckRate));
+	RouterToRouter.SetChannelAttribute ("Delay", StringValue (config.bottleneckDelay));
+	string bottleneckLimit = QueueLimit (config.bottleneckRate, config.bottleneckDelay, 1500, config.queueBytes);
+	string qdiscType = QueueDiscTypeName (config.qdisc);
+	RouterToRouter.SetQueue("ns3::DropTailQueue<Packet>", "MaxSize", StringValue(qdiscType.empty() ? bottleneckLimit : "1p"));
+	
+	NetDeviceContainer E1R1 = HostToRouter.Install (edges.Get (0), routers.Get (0));
+	NetDeviceContainer R1R2 = RouterToRouter.Install (routers.Get (0), routers.Get (1));
+	NetDeviceContainer R2E2 = HostToRouter.Install (routers.Get (1), edges.Get (1));
+	Ipv4AddressHelper ipv4_E1R1;
+	ipv4_E1R1.SetBase ("10.2.0.0", "255.255.255.252");
+	Ipv4InterfaceContainer E1R1Interface = ipv4_E1R1.Assign (E1R1);
+	Ipv4AddressHelper ipv4_R1R2;
+	ipv4_R1R2.SetBase ("10.1.2.0", "255.255.255.0");
+	Ipv4InterfaceContainer R1R2Interface = ipv4_R1R2.Assign (R1R2);
+	Ipv4AddressHelper ipv4_R2E2;
+	ipv4_R2E2.SetBase ("10.3.0.0", "255.255.255.252");
+	Ipv4InterfaceContainer R2E2Interface = ipv4_R2E2.Assign (R2E2);
+	
+	//everything goes towards the far namespace by default; the routers know the near one
+	AddDefaultRoute (E1R1.Get (0), E1R1Interface.GetAddress (1));
+	AddDefaultRoute (R1R2.Get (0), R1R2Interface.GetAddress (1));
+	AddDefaultRoute (R1R2.Get (1), R1R2Interface.GetAddress (0));
+	AddDefaultRoute (R2E2.Get (1), R2E2Interface.GetAddress (0));
+	AddNetworkRoute (E1R1.Get (1), "10.1.1.0", "255.255.255.0", E1R1Interface.GetAddress (0));
+	AddNetworkRoute (R2E2.Get (0), "10.1.3.0", "255.255.255.0", R2E2Interface.GetAddress (1));
+	
+	TrafficControlHelper trafficControl;
+	QueueDiscContainer bottleneckQueueDiscs;
+	if(config.qdisc!="default")
+		trafficControl.Uninstall (R1R2);
+	if(!qdiscType.empty())
+	{
+		trafficControl.SetRootQueueDisc (qdiscType, "MaxSize", QueueSizeValue (QueueSize (bottleneckLimit)));
+		bottleneckQueueDiscs = trafficControl.Install (R1R2);
+	}
+	QueueMonitor queueMonitor ("", 0);
+	if(!qdiscType.empty())
+		queueMonitor.WatchQueueDisc (bottleneckQueueDiscs.Get (0));
+	else
+		queueMonitor.WatchDeviceQueue (DynamicCast<PointToPointNetDevice> (R1R2.Get (0))->GetQueue ());
+	
+	//left to right is the data direction
+	SinkStats bottleneckStats {0, 0, 0};
+	R1R2.Get (1)->TraceConnectWithoutContext ("MacRx", MakeBoundCallback (&RecordLinkRx, &bottleneckStats));
+	
+	NS_LOG_INFO("Emulating a "+ config.bottleneckRate +"/"+ config.bottleneckDelay +" bottleneck between "+ leftDevice +" and "+ rightDevice +" for "+ to_string(seconds) +" s");
+	LagMonitor lag (MilliSeconds (1), Seconds (deadline));
+	Simulator::Stop (Seconds (seconds));
+	lag.Start ();
+	auto wallStart = chrono::steady_clock::now ();
+	Simulator::Run ();
+	double wallSeconds = chrono::duration<double> (chrono::steady_clock::now () - wallStart).count ();
+	queueMonitor.Finish ();
+	uint64_t events = Simulator::GetEventCount ();
+	Simulator::Destroy ();
+	
+	double duration = (bottleneckStats.lastRxNs-bottleneckStats.firstRxNs)/1e9;
+	double throughput = duration>0 ? 8.0*bottleneckStats.rxBytes/(1000*duration) : 0;
+	double missed = lag.GetProbes ()>0 ? 100.0*lag.GetMissed ()/lag.GetProbes () : 0;
+	NS_LOG_INFO("Bottleneck throughput: "+ to_string(throughput) +" Kbps ("+ to_string(bottleneckStats.rxBytes) +" bytes)");
+	NS_LOG_INFO("Queueing delay: mean "+ to_string(1000*queueMonitor.GetMeanSojourn ()) +" ms, max "+ to_string(1000*queueMonitor.GetMaxSojourn ()) +" ms");
+	NS_LOG_INFO("Real-time lag: mean "+ to_string(1000*lag.GetMeanLag ()) +" ms, p99 "+ to_string(1000*lag.GetLagQuantile (0.99)) +" ms, max "+ to_string(1000*lag.GetMaxLag ()) +" ms");
+	NS_LOG_INFO("Missed deadlines: "+ to_string(lag.GetMissed ()) +" of "+ to_string(lag.GetProbes ()) +" probes ("+ to_string(missed) +"%) more than "+ to_string(1000*deadline) +" ms late");
+	NS_LOG_INFO("Events: "+ to_string(events) +" in "+ to_string(wallSeconds) +" s wall ("+ to_string(wallSeconds>0 ? events/wallSeconds : 0) +" per second)");
+	if(missed<1)
+		NS_LOG_INFO("The emulator kept up with the "+ config.bottleneckRate +" bottleneck");
+	else
+		NS_LOG_INFO("The emulator fell behind real time: try a lower --bottleneck-rate");
+}
+#endif
+
+
+// Runs one packet size at every load level of one kind of cross traffic (udp or web), all
+// points in one worker pool, and reports how the measured flows fare as the load grows
+void RunLoadSweep (const SweepConfig &config, int segment_size, string kind, const vector<double> &loads, int jobs)
+{
+	vector<SweepConfig> points;
+	for(size_t l=0;l<loads.size();l++)
+	{
+		SweepConfig point = config;
+		point.writeXml = false;
+		point.trace = false;
+		if(kind=="web")
+			point.crossWebLoad = loads[l];
+		else
+			point.crossUdpLoad = loads[l];
+		points.push_back (point);
+	}
+	vector<SweepResult> results = RunPoints (points, vector<int> (points.size (), segment_size), jobs);
+	
+	ofstream loadFile(("wired_TCP_"+config.agent+"_load.csv").c_str());
+	loadFile << "agent,segment_size,load_kind,load,throughput_kbps,goodput_kbps,p99_delay_s,cross_udp_kbps,cross_tcp_kbps,cross_web_kbps,agent_fairness,web_transfers,web_fct_p99_s\n";
+	
+	NS_LOG_INFO("Load sweep of the "+ kind +" cross traffic - packet size "+ to_string(segment_size) +" ("+ DescribeCrossTraffic (config) +")");
+	NS_LOG_INFO("+-----------------------------------------------------------------------------------------------------------------------------------+");
+	NS_LOG_INFO("|   Load   |   Throughput   |    Goodput    | p99 Delay (ms) | Cross (Kbps) | Competing TCP (Kbps) | Inter-agent Fairness | Web p99 FCT (s) |");
+	NS_LOG_INFO("+-----------------------------------------------------------------------------------------------------------------------------------+");
+	for(size_t l=0;l<loads.size();l++)
+	{
+		const SweepResult &result = results[l];
+		double cross = result.crossUdpThroughput + result.crossTcpThroughput + result.crossWebThroughput;
+		NS_LOG_INFO("|   "+ to_string(loads[l]) +"   |   "+ to_string(result.throughput) +"   |   "+ to_string(result.goodput) +"   |   "+ to_string(1000*result.delayPercentiles[2]) +"   |   "+ to_string(cross)
+			+"   |   "+ to_string(result.crossTcpThroughput) +"   |   "+ to_string(result.agentFairness) +"   |   "+ to_string(result.webFctP99) +"   |"+ (result.cached ? "  (cached)" : ""));
+		loadFile << config.agent << "," << segment_size << "," << kind << "," << loads[l] << "," << result.throughput << "," << result.goodput << "," << result.delayPercentiles[2] << ","
+			<< result.crossUdpThroughput << "," << result.crossTcpThroughput << "," << result.crossWebThroughput << "," << result.agentFairness << ","
+			<< result.webTransfers << "," << result.webFctP99 << "\n";
+	}
+	NS_LOG_INFO("+-----------------------------------------------------------------------------------------------------------------------------------+");
+}
+
+
 int main(int argc, char *argv[])
 {	
 	//Set time resolution
@@ -140,9 +1370,154 @@ int main(int argc, char *argv[])
 	//obtaining TCP agent
 	string socket_type;
 	CommandLine cmd;
+	int jobs = 1;
+	uint32_t flows = 1;
+	string topology = "dumbbell";
+	bool emulate = false;
+	string emulate_left = "veth-left-sim";
+	string emulate_right = "veth-right-sim";
+	double emulate_seconds = 60;
+	double emulate_deadline = 0.001;
+	bool distributed = false;
+	int distributed_size = 1500;
+	bool write_xml = false;
+	bool trace = false;
+	double trace_interval = 0.01;
+	uint32_t trace_buffer = 65536;
+	bool trace_benchmark = false;
+	bool converge = false;
+	double converge_interval = 0.2;
+	uint32_t converge_window = 10;
+	double converge_tolerance = 0.02;
+	bool converge_check = false;
+	uint32_t replications = 1;
+	bool crn = false;
+	string qdisc = "default";
+	string queue_unit = "packets";
+	bool queue_trace = false;
+	double delay_bin = 0.001;
+	string measure = "flowmon";
+	bool measure_benchmark = false;
+	string workload = "cbr";
+	string ftp_sizes = "fixed";
+	double ftp_mean = 1000000;
+	double ftp_rate = 0;
+	uint32_t ftp_transfers = 20;
+	string send_mode = "paced";
+	bool send_benchmark = false;
+	bool reuse_payload = true;
+	bool alloc_benchmark = false;
+	string scheduler = "map";
+	string routing = "global";
+	int scheduler_benchmark = 0;
+	int load_sweep = 0;
+	string loads = "0,0.2,0.4,0.6,0.8";
+	string load_kind = "udp";
+	string sink_stats_file;
+	string baseline_file;
+	string cache_dir;
+	int adaptive = 0;
+	int adaptive_min = 40;
+	int adaptive_max = 1500;
+	double adaptive_tolerance = 50;
+	SweepConfig config;
+	config.accessRate = "100Mbps";
+	config.accessDelay = "20ms";
+	config.bottleneckRate = "10Mbps";
+	config.bottleneckDelay = "50ms";
+	config.appRate = "20Mbps";
+	config.packetsPerFlow = 10000;
+	config.crossUdpLoad = 0;
+	config.crossWebLoad = 0;
+	config.webMeanBytes = 50000;
+	config.crossTcp = 0;
+	config.crossAgent = "NewReno";
+	config.crossDelay = "10ms";
+	config.spines = 4;
+	config.leaves = 4;
+	config.hostsPerLeaf = 8;
+	config.fatTreeK = 4;
+	config.ecmp = false;
 	cmd.AddValue ("agent", "The TCP agent you want to use:", socket_type);
+	cmd.AddValue ("jobs", "Number of worker processes running sweep points in parallel (0 = all cores)", jobs);
+	cmd.AddValue ("flows", "Number of sender/receiver pairs sharing the bottleneck", flows);
+	cmd.AddValue ("topology", "Network: dumbbell, leafspine or fattree (generated fabrics carry --flows flows between hosts under different leaves)", topology);
+	cmd.AddValue ("spines", "Spine switches of the leaf-spine fabric", config.spines);
+	cmd.AddValue ("leaves", "Leaf switches of the leaf-spine fabric", config.leaves);
+	cmd.AddValue ("hosts-per-leaf", "Hosts under every leaf of the leaf-spine fabric", config.hostsPerLeaf);
+	cmd.AddValue ("fat-tree-k", "Ports per switch of the fat-tree fabric (even); it has k^3/4 hosts", config.fatTreeK);
+	cmd.AddValue ("ecmp", "Let global routing spray packets over equal-cost paths, per packet (reorders the segments of a flow)", config.ecmp);
+	cmd.AddValue ("access-rate", "Data rate of the host to router links", config.accessRate);
+	cmd.AddValue ("access-delay", "Delay of the host to router links", config.accessDelay);
+	cmd.AddValue ("bottleneck-rate", "Data rate of the router to router link (switch to switch links in a fabric)", config.bottleneckRate);
+	cmd.AddValue ("bottleneck-delay", "Delay of the router to router link (switch to switch links in a fabric)", config.bottleneckDelay);
+	cmd.AddValue ("app-rate", "Data rate of every sender in the paced send mode", config.appRate);
+	cmd.AddValue ("packets", "Number of packets every sender sends", config.packetsPerFlow);
+	cmd.AddValue ("xml", "Also write the per-point FlowMonitor XML files (with histograms and probes)", write_xml);
+	cmd.AddValue ("trace", "Sample cwnd, RTT, bytes in flight and goodput of every flow into <prefix>_<size>.ts files", trace);
+	cmd.AddValue ("trace-interval", "Seconds between two time-series samples", trace_interval);
+	cmd.AddValue ("trace-buffer", "Number of samples buffered in memory before a batch is written", trace_buffer);
+	cmd.AddValue ("send-mode", "How senders push data: paced (timer at the app data rate) or bulk (refill on free send buffer)", send_mode);
+	cmd.AddValue ("send-benchmark", "Run the sweep in both send modes and compare events and wall time", send_benchmark);
+	cmd.AddValue ("reuse-payload", "Send copies of a preallocated payload template instead of allocating each packet", reuse_payload);
+	cmd.AddValue ("alloc-benchmark", "Run the sweep with and without payload reuse and compare heap allocations and wall time", alloc_benchmark);
+	cmd.AddValue ("scheduler", "Event scheduler: map, heap, list, calendar or priority", scheduler);
+	cmd.AddValue ("routing", "IPv4 routing: global (SPF from every node), nix (nix-vector, on demand) or static (default routes of the topology)", routing);
+	cmd.AddValue ("scheduler-benchmark", "Only run this packet size once under every scheduler and compare them", scheduler_benchmark);
+	cmd.AddValue ("cross-udp", "UDP on/off cross traffic across the bottleneck, as a share of its rate (0 = none)", config.crossUdpLoad);
+	cmd.AddValue ("cross-web", "Short web-like TCP transfers across the bottleneck, as a share of its rate (0 = none)", config.crossWebLoad);
+	cmd.AddValue ("web-mean", "Mean size in bytes of the web-like transfers (Pareto)", config.webMeanBytes);
+	cmd.AddValue ("cross-tcp", "Number of competing long-lived TCP flows across the bottleneck", config.crossTcp);
+	cmd.AddValue ("cross-agent", "Agent of the competing flows: NewReno, Cubic, Westwood, Veno or Vegas", config.crossAgent);
+	cmd.AddValue ("cross-delay", "One-way delay of each cross-traffic access link, which sets the competing flows' RTT", config.crossDelay);
+	cmd.AddValue ("load-sweep", "Only run this packet size at every --loads level of the --load-kind cross traffic", load_sweep);
+	cmd.AddValue ("loads", "Comma-separated cross-traffic loads of the load sweep, as shares of the bottleneck rate", loads);
+	cmd.AddValue ("load-kind", "Cross traffic the load sweep varies: udp or web", load_kind);
+	cmd.AddValue ("trace-benchmark", "Rerun the sweep without tracing and report the tracing overhead", trace_benchmark);
+	cmd.AddValue ("converge", "Stop every run once all data is delivered or the goodput is steady", converge);
+	cmd.AddValue ("converge-interval", "Seconds between two convergence checks", converge_interval);
+	cmd.AddValue ("converge-window", "Number of intervals the goodput has to be steady over", converge_window);
+	cmd.AddValue ("converge-tolerance", "Relative 95% confidence half-width of the goodput counted as steady", converge_tolerance);
+	cmd.AddValue ("converge-check", "Rerun the sweep to full length and compare throughput and wall time", converge_check);
+	cmd.AddValue ("replications", "Independent runs of every point (RNG run numbers from --RngRun on); reports mean and 95% CI", replications);
+	cmd.AddValue ("crn", "Use common random numbers: the same run numbers for every agent", crn);
+	cmd.AddValue ("qdisc", "Queue disc on the bottleneck: default, none (device DropTail only), codel, fqcodel, pie or red", qdisc);
+	cmd.AddValue ("queue-unit", "Size the queues to one bandwidth-delay product in packets or in bytes", queue_unit);
+	cmd.AddValue ("delay-bin", "Bin width (seconds) of the FlowMonitor delay and jitter histograms the percentiles come from", delay_bin);
+	cmd.AddValue ("measure", "How flows are measured: flowmon (FlowMonitor) or sink (constant-memory counters on the hosts)", measure);
+	cmd.AddValue ("measure-benchmark", "Run the sweep with both measurement modes and compare throughput, wall time and peak RSS", measure_benchmark);
+	cmd.AddValue ("workload", "Traffic of the senders: cbr (constant-rate packets) or ftp (file transfers)", workload);
+	cmd.AddValue ("ftp-sizes", "File size distribution of the ftp workload: fixed, lognormal or pareto", ftp_sizes);
+	cmd.AddValue ("ftp-mean", "Mean file size of the ftp workload, in bytes", ftp_mean);
+	cmd.AddValue ("ftp-rate", "Poisson arrival rate of transfers per sender and second (0 = one transfer after another)", ftp_rate);
+	cmd.AddValue ("ftp-transfers", "Number of transfers per sender", ftp_transfers);
+	cmd.AddValue ("queue-trace", "Record the queueing delay and occupancy of every packet leaving the bottleneck queue", queue_trace);
+	cmd.AddValue ("emulate", "Run the dumbbell in real time between two veth interfaces, for real TCP stacks (needs root)", emulate);
+	cmd.AddValue ("emulate-left", "Interface the data senders are behind (10.1.1.0/24)", emulate_left);
+	cmd.AddValue ("emulate-right", "Interface the data receivers are behind (10.1.3.0/24)", emulate_right);
+	cmd.AddValue ("emulate-seconds", "Length of the emulation run, in seconds", emulate_seconds);
+	cmd.AddValue ("emulate-deadline", "Real-time lag (seconds) beyond which a lag probe counts as a missed deadline", emulate_deadline);
+	cmd.AddValue ("distributed", "Split the topology over MPI logical processes (run under mpirun)", distributed);
+	cmd.AddValue ("distributed-size", "Packet size of the single point a distributed run simulates", distributed_size);
+	cmd.AddValue ("sink-stats", "Write per-flow sink counters and run times to this file", sink_stats_file);
+	cmd.AddValue ("baseline", "Sink counters file of a reference run to report speedup and equality against", baseline_file);
+	cmd.AddValue ("cache-dir", "Directory of cached sweep point results; points already in it are not run again", cache_dir);
+	cmd.AddValue ("adaptive", "Instead of the fixed packet sizes, pick this many sizes where the throughput changes most", adaptive);
+	cmd.AddValue ("adaptive-min", "Smallest packet size of the adaptive sweep", adaptive_min);
+	cmd.AddValue ("adaptive-max", "Largest packet size of the adaptive sweep", adaptive_max);
+	cmd.AddValue ("adaptive-tolerance", "Throughput change (Kbps) between neighbouring sizes below which the adaptive sweep stops refining", adaptive_tolerance);
 	cmd.Parse (argc, argv);
 	
+	if(jobs<=0)
+	{
+		jobs = sysconf(_SC_NPROCESSORS_ONLN);
+	}
+	if(flows<1 || flows>16384)
+	{
+		NS_LOG_INFO("Invalid number of flows, please enter a value between 1 and 16384");
+		exit(1);
+	}
+	
 	// setting socket type (according to TCP-agent)
 	if(socket_type=="Westwood")
 	{
@@ -156,23 +1531,274 @@ int main(int argc, char *argv[])
 	{
 		Config::SetDefault ("ns3::TcpL4Protocol::SocketType", StringValue ("ns3::TcpVegas"));
 	}
-	else
+	else if(!emulate)
 	{
 		NS_LOG_INFO("Invalid TCP agent, please enter one among {Westwood, Veno, Vegas}");
 		exit(1);
 	}
 			
 	
-	NS_LOG_INFO("Wired_TCP - "+ socket_type);
-	NS_LOG_INFO("+-----------------------------------------------+");
-	NS_LOG_INFO("|Packet Size  |   Throughput   |  Fairness Index|");
-	NS_LOG_INFO("+-----------------------------------------------+");
+	config.agent = socket_type;
+	config.flows = flows;
+	config.topology = topology;
+	config.distributed = distributed;
+	config.writeXml = write_xml;
+	config.trace = trace || trace_benchmark;
+	config.traceInterval = trace_interval;
+	config.traceBuffer = trace_buffer;
+	config.bulkSend = send_mode=="bulk";
+	config.reusePayload = reuse_payload;
+	config.scheduler = scheduler;
+	config.routing = routing;
+	config.isolatePoints = measure_benchmark;
+	config.cacheDir = cache_dir;
+	config.converge = converge || converge_check;
+	config.convergeInterval = converge_interval;
+	config.convergeWindow = converge_window;
+	config.convergeTolerance = converge_tolerance;
+	config.qdisc = qdisc;
+	config.queueBytes = queue_unit=="bytes";
+	config.queueTrace = queue_trace;
+	config.delayBinWidth = delay_bin;
+	config.sinkMeasure = measure=="sink";
+	config.ftp = workload=="ftp";
+	config.ftpSizes = ftp_sizes;
+	config.ftpMeanBytes = ftp_mean;
+	config.ftpArrivalRate = ftp_rate;
+	config.ftpTransfers = ftp_transfers;
+	config.seed = RngSeedManager::GetSeed ();
+	config.run = RngSeedManager::GetRun ();
+	
+	if(topology!="dumbbell" && topology!="leafspine" && topology!="fattree")
+	{
+		NS_LOG_INFO("Invalid topology, please enter one among {dumbbell, leafspine, fattree}");
+		exit(1);
+	}
+	if(topology=="leafspine" && (config.spines<1 || config.leaves<2 || config.hostsPerLeaf<1))
+	{
+		NS_LOG_INFO("The leaf-spine fabric needs at least 1 spine, 2 leaves and 1 host per leaf");
+		exit(1);
+	}
+	if(topology=="fattree" && (config.fatTreeK<2 || config.fatTreeK%2!=0 || config.fatTreeK>64))
+	{
+		NS_LOG_INFO("The fat-tree fabric needs an even --fat-tree-k between 2 and 64");
+		exit(1);
+	}
+	if(topology!="dumbbell" && flows>GetFabricShape (config).hosts/2)
+	{
+		NS_LOG_INFO("Too many flows for the fabric: every flow needs its own sender and receiver host, at most "+ to_string(GetFabricShape (config).hosts/2) +" flows");
+		exit(1);
+	}
+	if(topology!="dumbbell" && (distributed || qdisc!="default" || queue_trace))
+	{
+		NS_LOG_INFO("The generated fabrics have no single bottleneck queue and are not available in distributed runs: run them without --distributed, --qdisc and --queue-trace");
+		exit(1);
+	}
+	
+	if(routing!="global" && routing!="nix" && routing!="static")
+	{
+		NS_LOG_INFO("Invalid routing, please enter one among {global, nix, static}");
+		exit(1);
+	}
+	if(config.ecmp && routing!="global")
+	{
+		NS_LOG_INFO("--ecmp is per-packet spraying by global routing, please run it with --routing=global");
+		exit(1);
+	}
+	
+	if(SchedulerTypeName (scheduler).empty())
+	{
+		NS_LOG_INFO("Invalid scheduler, please enter one among {map, heap, list, calendar, priority}");
+		exit(1);
+	}
+	
+	if(send_mode!="paced" && send_mode!="bulk")
+	{
+		NS_LOG_INFO("Invalid send mode, please enter one among {paced, bulk}");
+		exit(1);
+	}
+	if((send_benchmark || alloc_benchmark) && config.trace)
+	{
+		NS_LOG_INFO("The send and allocation benchmarks compare untraced runs, please run them without --trace");
+		exit(1);
+	}
+#ifndef COUNT_HEAP_ALLOCATIONS
+	if(alloc_benchmark)
+	{
+		NS_LOG_INFO("The allocation benchmark counts allocations through a replaced operator new, please rebuild with -DCOUNT_HEAP_ALLOCATIONS");
+		exit(1);
+	}
+#endif
+	
+	if(config.trace && (distributed || trace_interval<=0))
+	{
+		NS_LOG_INFO("Tracing needs a positive --trace-interval and is not available in distributed runs");
+		exit(1);
+	}
+	config.systemId = 0;
+	config.systemCount = 1;
+	
+	if(adaptive!=0 && (adaptive<3 || adaptive_min<1 || adaptive_max<=adaptive_min || adaptive_tolerance<0))
+	{
+		NS_LOG_INFO("The adaptive sweep needs --adaptive of at least 3 and --adaptive-min < --adaptive-max");
+		exit(1);
+	}
+	if(adaptive!=0 && distributed)
+	{
+		NS_LOG_INFO("The adaptive sweep is not available in distributed runs");
+		exit(1);
+	}
+	
+	if(config.converge && (converge_interval<=0 || converge_window<2 || converge_tolerance<=0))
+	{
+		NS_LOG_INFO("Early termination needs a positive --converge-interval and --converge-tolerance and a --converge-window of at least 2");
+		exit(1);
+	}
+	if(config.converge && distributed)
+	{
+		NS_LOG_INFO("Early termination is not available in distributed runs");
+		exit(1);
+	}
+	
+	if(!IsQueueDiscName (qdisc) || (queue_unit!="packets" && queue_unit!="bytes"))
+	{
+		NS_LOG_INFO("Invalid queue setup, please enter a --qdisc among {default, none, codel, fqcodel, pie, red} and a --queue-unit among {packets, bytes}");
+		exit(1);
+	}
+	if((workload!="cbr" && workload!="ftp") || (ftp_sizes!="fixed" && ftp_sizes!="lognormal" && ftp_sizes!="pareto") || ftp_mean<1 || ftp_rate<0)
+	{
+		NS_LOG_INFO("Invalid workload, please enter a --workload among {cbr, ftp}, --ftp-sizes among {fixed, lognormal, pareto} and a positive --ftp-mean");
+		exit(1);
+	}
+	if(config.ftp && (config.trace || config.converge || send_benchmark || alloc_benchmark || distributed))
+	{
+		NS_LOG_INFO("The ftp workload has no constant-rate sender to trace, stop early or benchmark, and is not available in distributed runs");
+		exit(1);
+	}
+	if(delay_bin<=0)
+	{
+		NS_LOG_INFO("Invalid --delay-bin, please enter a positive bin width in seconds");
+		exit(1);
+	}
+	if((measure!="flowmon" && measure!="sink") || ((config.sinkMeasure || measure_benchmark) && (write_xml || distributed)))
+	{
+		NS_LOG_INFO("Invalid measurement mode, please enter a --measure among {flowmon, sink}; the sink mode writes no FlowMonitor XML, and distributed runs always measure at the sinks");
+		exit(1);
+	}
+	vector<double> load_levels;
+	if(config.crossUdpLoad<0 || config.crossUdpLoad>=1 || config.crossWebLoad<0 || config.crossWebLoad>=1 || config.webMeanBytes<1
+		|| config.crossTcp>64 || CrossAgentTypeName (config.crossAgent).empty() || (load_kind!="udp" && load_kind!="web")
+		|| (load_sweep>0 && (!ParseValues (loads, load_levels) || *min_element (load_levels.begin(), load_levels.end())<0 || *max_element (load_levels.begin(), load_levels.end())>=1)))
+	{
+		NS_LOG_INFO("Invalid cross traffic, please enter loads in [0, 1), at most 64 --cross-tcp flows, a --cross-agent among {NewReno, Cubic, Westwood, Veno, Vegas} and a --load-kind among {udp, web}");
+		exit(1);
+	}
+	if((HasCrossTraffic (config) || load_sweep>0) && (distributed || topology!="dumbbell" || emulate))
+	{
+		NS_LOG_INFO("Cross traffic runs on the dumbbell's bottleneck, please run it without --distributed, --topology and --emulate");
+		exit(1);
+	}
+	if(replications<1 || (replications>1 && adaptive>0))
+	{
+		NS_LOG_INFO("Invalid number of replications, please enter at least 1 (and do not combine replications with --adaptive)");
+		exit(1);
+	}
+	// without common random numbers every agent draws from its own block of run numbers
+	uint32_t first_run = config.run;
+	if(replications>1 && !crn)
+	{
+		uint32_t agent_index = socket_type=="Westwood" ? 0 : socket_type=="Veno" ? 1 : 2;
+		first_run += agent_index*replications;
+	}
+	
+	// Simulator::Destroy () tears down the parallel communication interface that
+	// MpiInterface::Enable set up, and it cannot be set up again for a second point, so a
+	// distributed run simulates exactly one point. MPI itself is finalized by
+	// MpiInterface::Disable () on the way out, so every check that can end the program
+	// comes before MPI is enabled.
+	if(distributed && (replications>1 || converge_check || send_benchmark || alloc_benchmark || measure_benchmark || scheduler_benchmark>0 || distributed_size<1))
+	{
+		NS_LOG_INFO("A distributed run simulates the single point --distributed-size, please run it without --replications, --converge-check and the benchmarks");
+		exit(1);
+	}
+#ifndef NS3_MPI
+	if(distributed)
+	{
+		NS_LOG_INFO("Distributed mode needs ns-3 built with MPI support (./ns3 configure --enable-mpi)");
+		exit(1);
+	}
+#endif
+	map<int, SweepResult> baseline;
+	if(!baseline_file.empty())
+		baseline = LoadSinkStats (baseline_file);
+	
+	// points with side outputs (XML, time series) or whose run times are compared are always run
+	if(!config.cacheDir.empty())
+	{
+		if(config.trace || queue_trace || write_xml || distributed || send_benchmark || alloc_benchmark || measure_benchmark || converge_check || scheduler_benchmark>0 || !baseline_file.empty())
+		{
+			NS_LOG_INFO("Not using the result cache: --xml, --trace, --distributed, --baseline and the benchmarks need fresh runs");
+			config.cacheDir = "";
+		}
+		else
+			config.binaryHash = BinaryFingerprint ();
+	}
+	
+	// the kernels at both ends run their own TCP; --agent does not apply
+	if(emulate)
+	{
+		if(distributed || topology!="dumbbell" || emulate_seconds<=0 || emulate_deadline<=0)
+		{
+			NS_LOG_INFO("Emulation needs a positive --emulate-seconds and --emulate-deadline and runs the dumbbell only, without --distributed");
+			exit(1);
+		}
+#ifdef HAVE_FD_NET_DEVICE
+		RunEmulation (config, emulate_left, emulate_right, emulate_seconds, emulate_deadline);
+		return 0;
+#else
+		NS_LOG_INFO("Emulation needs ns-3's fd-net-device module, which this ns-3 was built without");
+		exit(1);
+#endif
+	}
+	
+	if(scheduler_benchmark>0)
+	{
+		RunSchedulerBenchmark (config, scheduler_benchmark);
+		return 0;
+	}
+	if(load_sweep>0)
+	{
+		RunLoadSweep (config, load_sweep, load_kind, load_levels, jobs);
+		return 0;
+	}
+	
+#ifdef NS3_MPI
+	// setting up the distributed simulator: every rank builds the whole topology but
+	// only simulates the nodes it owns, and only rank 0 reports
+	if(distributed)
+	{
+		GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DistributedSimulatorImpl"));
+		MpiInterface::Enable (&argc, &argv);
+		config.systemId = MpiInterface::GetSystemId ();
+		config.systemCount = MpiInterface::GetSize ();
+		jobs = 1;
+		if(config.systemId!=0)
+		{
+			LogComponentDisable ("wired", LOG_LEVEL_ALL);
+		}
+	}
+#endif
+	
+	NS_LOG_INFO("Wired_TCP - "+ socket_type +" ("+ to_string(flows) +" flows"+ (topology=="dumbbell" ? string("") : ", "+ DescribeFabric (config)) +")");
+	NS_LOG_INFO("+---------------------------------------------------------------------------------------------------------------------------------------------------------------------+");
+	NS_LOG_INFO("|Packet Size  |   Throughput   |    Goodput    |  Fairness Index| p99 Delay (ms) | p99 Jitter (ms) |  Setup (s)  |  Wall (s)  |   Events   | Events/sec | Sim/Wall | Peak RSS (KB) |");
+	NS_LOG_INFO("+---------------------------------------------------------------------------------------------------------------------------------------------------------------------+");
 	
 	
 	//Generating Plots
 	string graphicsFileName = "Wired_TCP_"+socket_type+".png";
 	string plotFileName = "Wired_TCP_"+socket_type+".plt";
-	string plotTitle = "Throughput vs Packet size for TCP-"+socket_type;
+	string plotTitle = "Throughput vs Packet size for TCP-"+socket_type+ (topology=="dumbbell" ? string("") : " ("+ DescribeFabric (config) +")");
 	string dataTitle = "TCP-"+socket_type;
 	
 	Gnuplot plot (graphicsFileName);
@@ -188,131 +1814,157 @@ int main(int argc, char *argv[])
   	
 	int packet_sizes[10]={40, 44, 48, 52, 60, 552, 576, 628, 1420, 1500};
 	
-	for(int i=0;i<10;i++)
+	vector<int> segment_sizes (packet_sizes, packet_sizes+10);
+	if(distributed)
+		segment_sizes.assign (1, distributed_size);
+	vector<SweepResult> results;
+	vector<SweepResult> replicationRuns;
+	vector<ReplicationSummary> summaries;
+	if(adaptive>0)
 	{
+		results = RunAdaptiveSweep (config, adaptive_min, adaptive_max, adaptive, adaptive_tolerance, jobs);
+		segment_sizes.clear();
+		for(size_t i=0;i<results.size();i++)
+			segment_sizes.push_back (results[i].segmentSize);
+		plot.AppendExtra ("set xrange ["+ to_string(adaptive_min-20) +":"+ to_string(adaptive_max+20) +"]");
+	}
+	else if(replications>1)
+	{
+		replicationRuns = RunReplicatedSweep (config, segment_sizes, replications, first_run, jobs);
+		summaries = SummarizeReplications (replicationRuns, replications, results);
+		dataset.SetErrorBars (Gnuplot2dDataset::Y);
+	}
+	else
+		results = RunSweep (config, segment_sizes, jobs);
 	
-		//setting segment size
-		int segment_size=packet_sizes[i];
-		Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (segment_size));	
-		
-		//creating nodes
-		NodeContainer nodes;
-		nodes.Create(4);
-		
-		//creating links
-		PointToPointHelper HostToRouter;
-  		HostToRouter.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
-  		HostToRouter.SetChannelAttribute ("Delay", StringValue ("20ms"));
-  		int mxPacketsInQueue = (100*20*1000)/(8*segment_size);
-  		HostToRouter.SetQueue("ns3::DropTailQueue<Packet>", "MaxSize", StringValue(to_string(mxPacketsInQueue)+"p"));
-  		
-  		PointToPointHelper RouterToRouter;
-  		RouterToRouter.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
-  		RouterToRouter.SetChannelAttribute ("Delay", StringValue ("50ms"));
-		mxPacketsInQueue=(10*50*1000)/(8*segment_size);
-  		RouterToRouter.SetQueue("ns3::DropTailQueue<Packet>", "MaxSize", StringValue(to_string(mxPacketsInQueue)+"p"));
-  		
-  		
-  		//setting up links between nodes
-  		NetDeviceContainer Node2R1, R1R2, R2Node3;
-  		Node2R1 = HostToRouter.Install( nodes.Get(0), nodes.Get(1));
-  		R1R2 = RouterToRouter.Install( nodes.Get(1), nodes.Get(2));
-  		R2Node3 = HostToRouter.Install( nodes.Get(2), nodes.Get(3));
-  		
-  		//building Internet stack
-  		InternetStackHelper stack;
-  		stack.Install(nodes);
-  		
-  		//assigning Ip addresses
-  		Ipv4AddressHelper ipv4_Node2R1;
-	      	ipv4_Node2R1.SetBase( "10.1.1.0" , "255.255.255.0" );
-	      	Ipv4InterfaceContainer Node2R1Interface = ipv4_Node2R1.Assign ( Node2R1 );
-
-	      	Ipv4AddressHelper ipv4_R1R2;
-	      	ipv4_R1R2.SetBase( "10.1.2.0" , "255.255.255.0" );
-	      	Ipv4InterfaceContainer R1R2Interface = ipv4_R1R2.Assign ( R1R2 );
-
-	      	Ipv4AddressHelper ipv4_R2Node3;
-	      	ipv4_R2Node3.SetBase( "10.1.3.0" , "255.255.255.0" );
-	      	Ipv4InterfaceContainer R2Node3Interface = ipv4_R2Node3.Assign ( R2Node3 );
-	      	
-	      	
-	      	//Assigning port Number;
-	      	uint16_t sinkPort = 9898;
-	      	
-	      	Address sinkAddress = InetSocketAddress (R2Node3Interface.GetAddress (1), sinkPort);
-      		Address anyAddress = InetSocketAddress (Ipv4Address::GetAny (), sinkPort);
-      		
-      		
-      		
-      		//Creating application container
-      		PacketSinkHelper packetSinkHelper ("ns3::TcpSocketFactory", anyAddress);
-      		ApplicationContainer sinkApps = packetSinkHelper.Install (nodes.Get (3));
-      		//Set the start and stop times for the server-side
-      		sinkApps.Start (Seconds (0.));
-  		sinkApps.Stop (Seconds (20.));
-
-
-      		// Create a client socket
-      		Ptr<Socket> ns3TcpSocket = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
-      		//Create an Application
-      		Ptr<SimulatorApp> simulApp = CreateObject<SimulatorApp> ();
-      		simulApp->Setup(ns3TcpSocket, sinkAddress, segment_size, 10000, DataRate ("20Mbps"));  //can we change 1000, 20Mbps
-      		nodes.Get(0)->AddApplication(simulApp);
-      		//Set the start and stop times for the client-side
-      		simulApp->SetStartTime (Seconds (1.));
-      		simulApp->SetStopTime (Seconds (20.));
-
-
-		//populating routing tables         
-      		Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
-      		
-
-		//Flow monitor
-		Ptr<FlowMonitor> flowMonitor;
-		FlowMonitorHelper flowHelper;
-		flowMonitor = flowHelper.InstallAll();
-		
-		Simulator::Stop (Seconds (20));
-  		Simulator::Run ();
-  		
-  		// Output the data in xml format
-		flowMonitor->SerializeToXmlFile("wired_TCP_"+socket_type+"_"+std::to_string(segment_size)+".xml", true, true);
-  		
-  		//Obtaining statistics 
-  		auto statistics=flowMonitor->GetFlowStats().begin();
-  		
-  		double totData = 8.0 * statistics->second.rxBytes;
-  		double totTime = statistics->second.timeLastRxPacket.GetSeconds()-statistics->second.timeFirstRxPacket.GetSeconds();
-  		
-  		double throughput = totData/(1000*totTime);
-  		
-  		double sumThroughput=0;
-  		double sumSqThroughput=0;
-  		int n=0;
-  		
-  		sumThroughput += throughput;
-  		sumSqThroughput += throughput*throughput;
-  		n++;
-  		
-  		double jain_fairness = (sumThroughput*sumThroughput)/((n+0.0)*sumSqThroughput);
-  		
-  		Simulator::Destroy ();
-  		  		
-  		
-  		// Output results
-  		if(segment_size>=1000)
-  			NS_LOG_INFO("|    "+ to_string(segment_size) +"     |   "+ to_string(throughput) +"   |    "+ to_string(jain_fairness)+"    |");
-  		else if(segment_size<100)
-  			NS_LOG_INFO("|    "+ to_string(segment_size) +"       |   "+ to_string(throughput) +"   |    "+ to_string(jain_fairness)+"    |");
-  		else
-  			NS_LOG_INFO("|    "+ to_string(segment_size) +"      |   "+ to_string(throughput) +"   |    "+ to_string(jain_fairness)+"    |");
-  			
-  		//adding values to dataset
-      		dataset.Add (segment_size, throughput);
-
-	}
-	NS_LOG_INFO("+-----------------------------------------------+");
+	//flow statistics of the whole sweep go into one binary file, point by point
+	ofstream flowFile, perfFile, metricsFile;
+	if(config.systemId==0)
+	{
+		perfFile.open(("wired_TCP_"+socket_type+"_perf.csv").c_str());
+		metricsFile.open(("wired_TCP_"+socket_type+"_flowmetrics.csv").c_str());
+	}
+	if(config.systemId==0 && !distributed)
+	{
+		flowFile.open(("wired_TCP_"+socket_type+".flows").c_str(), ios::binary);
+		flowFile.write (FLOW_FILE_MAGIC, sizeof (FLOW_FILE_MAGIC));
+	}
+	
+	size_t reused = 0;
+	for(size_t i=0;i<results.size();i++)
+	{
+		// Output results
+		PrintResultRow (results[i]);
+		if(results[i].cached)
+			reused++;
+		if(perfFile.is_open())
+			WritePerfRow (perfFile, socket_type, results[i]);
+		if(metricsFile.is_open())
+			WriteFlowMetrics (metricsFile, socket_type, results[i]);
+		if(flowFile.is_open())
+			flowFile.write (results[i].flowRecords.data(), results[i].flowRecords.size());
+			
+		//adding values to dataset
+		if(summaries.empty())
+      			dataset.Add (results[i].segmentSize, results[i].throughput);
+		else
+			dataset.Add (summaries[i].segmentSize, summaries[i].mean, summaries[i].halfWidth);
+	}
+	NS_LOG_INFO("+---------------------------------------------------------------------------------------------------------------------------------------------------------------------+");
+	if(!config.cacheDir.empty())
+		NS_LOG_INFO(to_string(reused) +" of "+ to_string(results.size()) +" points taken from the result cache in "+ config.cacheDir);
+	if(config.converge)
+	{
+		int stops[3]={0, 0, 0};
+		double simulated=0;
+		for(size_t i=0;i<results.size();i++)
+		{
+			stops[results[i].stopReason]++;
+			simulated += results[i].simulatedSeconds;
+		}
+		NS_LOG_INFO("Early termination: "+ to_string(stops[STOP_COMPLETED]) +" points completed, "+ to_string(stops[STOP_STEADY]) +" steady, "+ to_string(stops[STOP_FULL_LENGTH]) +" ran to full length; "+ to_string(simulated) +" of "+ to_string(20.0*results.size()) +" simulated seconds");
+	}
+	if(adaptive>0)
+		NS_LOG_INFO("Adaptive sweep: "+ to_string(results.size()) +" packet sizes, largest throughput step between neighbours "+ to_string(LargestThroughputStep (results)) +" Kbps");
+	
+	if(config.systemId!=0)
+	{
+#ifdef NS3_MPI
+		MpiInterface::Disable ();
+#endif
+		return 0;
+	}
+	
+	if(!distributed)
+	{
+		PrintLatencyReport (results);
+		WriteLatencyPlot ("Wired_TCP_"+socket_type+"_latency.plt", socket_type, results);
+	}
+	if(qdisc!="default" || queue_trace)
+		PrintQueueReport (results);
+	if(HasCrossTraffic (config))
+		PrintCrossTrafficReport (config, results);
+	if(config.ftp)
+	{
+		PrintTransferReport (results);
+		WriteTransferPlot ("Wired_TCP_"+socket_type+"_fct.plt", socket_type, results);
+	}
+	if(!summaries.empty())
+	{
+		PrintReplicationSummary (summaries);
+		WriteReplications ("wired_TCP_"+socket_type+"_replications.csv", socket_type, replicationRuns);
+	}
+	if(!sink_stats_file.empty())
+		WriteSinkStats (sink_stats_file, results);
+	if(!baseline_file.empty())
+		PrintSpeedupReport (results, baseline);
+	if(converge_check)
+	{
+		SweepConfig full = config;
+		full.converge = false;
+		full.trace = false;
+		full.writeXml = false;
+		PrintConvergenceCheck (results, RunSweep (full, segment_sizes, jobs), converge_tolerance);
+	}
+	if(trace_benchmark)
+	{
+		SweepConfig untraced = config;
+		untraced.trace = false;
+		untraced.writeXml = false;
+		PrintTraceOverhead (results, RunSweep (untraced, segment_sizes, jobs));
+	}
+	if(alloc_benchmark)
+	{
+		SweepConfig other = config;
+		other.reusePayload = !config.reusePayload;
+		other.writeXml = false;
+		vector<SweepResult> otherResults = RunSweep (other, segment_sizes, jobs);
+		if(config.reusePayload)
+			PrintAllocationBenchmark (otherResults, results);
+		else
+			PrintAllocationBenchmark (results, otherResults);
+	}
+	if(measure_benchmark)
+	{
+		SweepConfig other = config;
+		other.sinkMeasure = !config.sinkMeasure;
+		vector<SweepResult> otherResults = RunSweep (other, segment_sizes, jobs);
+		if(config.sinkMeasure)
+			PrintMeasurementBenchmark (otherResults, results);
+		else
+			PrintMeasurementBenchmark (results, otherResults);
+	}
+	if(send_benchmark)
+	{
+		SweepConfig other = config;
+		other.bulkSend = !config.bulkSend;
+		other.writeXml = false;
+		vector<SweepResult> otherResults = RunSweep (other, segment_sizes, jobs);
+		if(config.bulkSend)
+			PrintSendModeComparison (otherResults, results);
+		else
+			PrintSendModeComparison (results, otherResults);
+	}
 	
 	//adding dataset and generating output file
   	plot.AddDataset (dataset);
@@ -322,6 +1974,10 @@ int main(int argc, char *argv[])
   	plot.GenerateOutput (plotFile);
 
   	plotFile.close ();
+#ifdef NS3_MPI
+	if(distributed)
+		MpiInterface::Disable ();
+#endif
   	return 0;
 
 }
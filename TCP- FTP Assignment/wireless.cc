@@ -7,9 +7,29 @@
 #include "ns3/flow-monitor-module.h"
 #include "ns3/wifi-module.h"
 #include "ns3/mobility-module.h"
+#include "ns3/traffic-control-module.h"
+#include "ns3/nix-vector-routing-module.h"
 #include "ns3/gnuplot.h"
 #include <string>
 #include <fstream>
+#include <vector>
+#include <map>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <memory>
+#include <deque>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <atomic>
+#include <cstring>
+#include <cmath>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
 
 
 using namespace std;
@@ -18,119 +38,1062 @@ using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE ("wireless");
 
-class SimulatorApp : public Application
+
+// Wi-Fi standards selectable with --wifi-standard, all on the 5 GHz band; "default" keeps
+// what WifiHelper sets up. Highest single-stream MCS and widest channel of each standard.
+const int WIFI_STANDARD_COUNT = 5;
+const char *WIFI_STANDARD_NAMES[WIFI_STANDARD_COUNT] = {"default", "a", "n", "ac", "ax"};
+const WifiStandard WIFI_STANDARDS[WIFI_STANDARD_COUNT] = {WIFI_STANDARD_80211a, WIFI_STANDARD_80211a, WIFI_STANDARD_80211n,
+                                                          WIFI_STANDARD_80211ac, WIFI_STANDARD_80211ax};
+const uint32_t WIFI_MAX_MCS[WIFI_STANDARD_COUNT] = {0, 7, 7, 9, 11};
+const uint32_t WIFI_MAX_WIDTH[WIFI_STANDARD_COUNT] = {0, 20, 40, 160, 160};
+// largest A-MPDU and A-MSDU each standard allows; ns-3 caps larger attribute values to these
+const int WIFI_MAX_AMPDU[WIFI_STANDARD_COUNT] = {0, 0, 65535, 1048575, 6500631};
+const int WIFI_MAX_AMSDU[WIFI_STANDARD_COUNT] = {0, 0, 7935, 11398, 11398};
+
+
+// Index of a --wifi-standard name; -1 if the name is unknown
+int WifiStandardIndex (string name)
 {
-	public:
-  		SimulatorApp ();
-  		virtual ~SimulatorApp ();
-  		void Setup (Ptr<Socket> socket, Address address, uint32_t packetSize, uint32_t nPackets, DataRate dataRate);
-
-	private:
-  		virtual void StartApplication (void);
-  		virtual void StopApplication (void);
-
-		  void ScheduleTx (void);
-		  void SendPacket (void);
-
-		  Ptr<Socket>     m_socket;
-		  Address         m_peer;
-		  uint32_t        m_packetSize;
-		  uint32_t        m_nPackets;
-		  DataRate        m_dataRate;
-		  EventId         m_sendEvent;
-		  bool            m_running;
-		  uint32_t        m_packetsSent;
-};
+  for (int i = 0; i < WIFI_STANDARD_COUNT; i++)
+    {
+      if (name == WIFI_STANDARD_NAMES[i])
+        {
+          return i;
+        }
+    }
+  return -1;
+}
 
 
-//Constructor
-SimulatorApp::SimulatorApp ()
+// Name of the ConstantRateWifiManager mode of an MCS; 802.11a has the eight OFDM rates
+string WifiModeName (string standard, uint32_t mcs)
 {
-    m_socket=0;
-    m_packetSize=0;
-    m_nPackets=0;
-    m_dataRate=0;
-    m_running=false;
-    m_packetsSent=0;
+  if (standard == "n")
+    {
+      return "HtMcs" + to_string (mcs);
+    }
+  if (standard == "ac")
+    {
+      return "VhtMcs" + to_string (mcs);
+    }
+  if (standard == "ax")
+    {
+      return "HeMcs" + to_string (mcs);
+    }
+  const char *rates[8] = {"6", "9", "12", "18", "24", "36", "48", "54"};
+  return string ("OfdmRate") + rates[mcs] + "Mbps";
 }
 
 
-//Deconstructor
-SimulatorApp::~SimulatorApp ()
+// TCP agents selectable with --agent, and the socket types behind them
+const int AGENT_COUNT = 3;
+const char *AGENT_NAMES[AGENT_COUNT] = {"Westwood", "Veno", "Vegas"};
+const char *AGENT_TYPES[AGENT_COUNT] = {"ns3::TcpWestwood", "ns3::TcpVeno", "ns3::TcpVegas"};
+
+
+// Socket type of an agent name; empty if the name is unknown
+string AgentTypeName (string name)
 {
-  m_socket = 0;
+  for (int i = 0; i < AGENT_COUNT; i++)
+    {
+      if (name == AGENT_NAMES[i])
+        {
+          return AGENT_TYPES[i];
+        }
+    }
+  return "";
 }
 
 
-// Initialise Parameters
-void SimulatorApp::Setup (Ptr<Socket> socket, Address address, uint32_t packetSize, uint32_t nPackets, DataRate dataRate)
+// Options shared by every point of the sweep
+struct SweepConfig
+{
+  string agent;
+  string backhaulRate;               // BaseToBase link
+  string backhaulDelay;
+  string wifiStandard;               // one of WIFI_STANDARD_NAMES
+  uint32_t channelWidth;             // MHz, 0 = the standard's default
+  string wifiManager;                // rate control: aarf, minstrel or constant
+  uint32_t mcs;                      // data rate of the constant manager
+  int ampduBytes;                    // best-effort A-MPDU and A-MSDU size limits (0 = off, -1 = ns-3 default)
+  int amsduBytes;
+  uint32_t stations;                 // hosts per cell; the hosts of the first cell send to those of the second
+  double errorRate;                  // RateErrorModel on the receivers of the lossy links (0 = none)
+  string errorUnit;                  // packet or bit
+  string errorLink;                  // backhaul (BaseToBase) or wifi (the PHYs of both cells)
+  uint32_t retryLimit;               // MAC retransmissions of a frame lost on the wifi error link
+  double distance;                   // metres between a station and its base station
+  string mobility;                   // static, or walk (random waypoints within the distance of the base station)
+  double walkSpeed;                  // m/s
+  double crossUdpLoad;               // UDP on/off cross traffic, as a share of the backhaul rate (0 = none)
+  double crossWebLoad;               // web-like transfers, as a share of the backhaul rate (0 = none)
+  double webMeanBytes;               // mean size of the web-like transfers
+  uint32_t crossTcp;                 // competing long-lived TCP flows
+  string crossAgent;                 // their agent, one of CROSS_AGENT_NAMES
+  string crossDelay;                 // one-way delay of each cross-traffic access link
+  string appRate;                    // data rate of the sender
+  uint32_t packetsPerFlow;
+  bool writeXml;                     // also write the per-point FlowMonitor XML files
+  bool trace;                        // sample cwnd, RTT, bytes in flight and goodput over time
+  double traceInterval;              // seconds between samples
+  uint32_t traceBuffer;              // samples buffered before a batch is written
+  bool bulkSend;                     // senders refill the socket buffer instead of pacing
+  bool reusePayload;                 // senders copy a shared payload template per packet
+  string scheduler;                  // event scheduler, one of SCHEDULER_NAMES
+  string routing;                    // global, nix or static
+  bool isolatePoints;                // run every point in a worker process, even with one job
+  string qdisc;                      // queue disc on the bottleneck, one of QDISC_NAMES
+  bool queueBytes;                   // size queues in bytes instead of packets
+  bool queueTrace;                   // record every packet leaving the bottleneck queue
+  double delayBinWidth;              // FlowMonitor delay and jitter histogram bins, in seconds
+  bool sinkMeasure;                  // measure with FlowMeter counters on the hosts instead of FlowMonitor
+  bool ftp;                          // file transfers instead of the constant-rate sender
+  string ftpSizes;                   // file size distribution: fixed, lognormal or pareto
+  double ftpMeanBytes;
+  double ftpArrivalRate;             // Poisson transfers per second and sender (0 = one after another)
+  uint32_t ftpTransfers;             // transfers per sender
+  uint32_t seed;                     // RngSeedManager seed and run number of the point
+  uint32_t run;
+  bool converge;                     // stop a run once its data is delivered or its goodput settles
+  double convergeInterval;           // seconds between two convergence checks
+  uint32_t convergeWindow;           // intervals the goodput must be steady over
+  double convergeTolerance;          // relative 95% confidence half-width counted as steady
+  string cacheDir;                   // reuse results of identical points from here (empty = off)
+  string binaryHash;                 // fingerprint of this executable, part of every cache key
+};
+
+
+// Per-flow measurements of one sweep point. The forward (data) and reverse (ACK) directions
+// of a TCP connection are separate FlowMonitor flows, told apart by the sink port.
+struct FlowMetrics
+{
+  uint32_t flow;
+  double throughput;                 // data direction, IP bytes received, in Kbps
+  double goodput;                    // application bytes received by the PacketSink, in Kbps
+  double lossRate;                   // data packets lost / sent
+  double meanDelay;                  // data one-way delay, in seconds
+  double ackThroughput;              // ACK direction, IP bytes received, in Kbps
+  uint64_t ackPackets;
+};
+
+
+// Results of a single sweep point
+struct SweepResult
 {
-  m_socket = socket;
-  m_peer = address;
-  m_packetSize = packetSize;
-  m_nPackets = nPackets;
-  m_dataRate = dataRate;
+  int segmentSize;
+  double throughput;
+  double goodput;                    // application goodput, in Kbps
+  vector<FlowMetrics> flowMetrics;
+  double fairness;
+  string flowRecords;                // encoded rows of the binary flow statistics file
+  uint64_t events;
+  double wallSeconds;
+  double setupSeconds;               // building the topology and routing, before Simulator::Run ()
+  double routingSeconds;             // of which filling the routing tables
+  uint64_t traceSamples;
+  uint64_t rejectedPackets;          // sends refused by a full socket buffer
+  uint64_t heapAllocations;          // made during Simulator::Run ()
+  double simulatedSeconds;
+  uint64_t peakRssKb;
+  uint32_t stopReason;               // a StopReason
+  uint32_t run;                      // RngSeedManager run number
+  double queueDelayMean;             // bottleneck queueing delay, in seconds
+  double queueDelayMax;
+  double queueBytesMean;             // bytes queued behind a departing packet
+  uint32_t transfersStarted;         // file transfers (ftp workload)
+  uint32_t transfersCompleted;
+  double fctP50;                     // flow completion times, in seconds
+  double fctP99;
+  double fctP999;
+  double slowdownMean;               // completion time over the ideal one
+  double slowdownP99;
+  double delayPercentiles[4];        // p50, p90, p99 and p99.9 one-way delay of the data, in seconds
+  double jitterPercentiles[4];
+  double crossUdpThroughput;         // cross traffic received, in Kbps
+  double crossTcpThroughput;         // all competing long-lived TCP flows
+  double crossWebThroughput;
+  uint32_t webTransfers;             // web-like transfers completed
+  double webFctP99;                  // their p99 completion time, in seconds
+  double agentFairness;              // Jain index over the measured and the competing long-lived flows
+  bool cached;                       // read from the result cache (not serialized)
+};
+
+
+// Receiver-side counters of one flow, taken from the PacketSink Rx trace
+struct SinkStats
+{
+  uint64_t rxBytes;
+  int64_t firstRxNs;
+  int64_t lastRxNs;
+};
+
+
+// code shared with wired.cc
+#include "sweep-common.inc"
+
+
+// Encoding of a result for the trip from a worker process back to the parent
+string SerializeResult (const SweepResult &result)
+{
+  string buffer;
+  AppendValue (buffer, result.segmentSize);
+  AppendValue (buffer, result.throughput);
+  AppendValue (buffer, result.fairness);
+  AppendValue (buffer, result.goodput);
+  AppendVector (buffer, result.flowMetrics);
+  AppendString (buffer, result.flowRecords);
+  AppendValue (buffer, result.events);
+  AppendValue (buffer, result.wallSeconds);
+  AppendValue (buffer, result.setupSeconds);
+  AppendValue (buffer, result.routingSeconds);
+  AppendValue (buffer, result.traceSamples);
+  AppendValue (buffer, result.rejectedPackets);
+  AppendValue (buffer, result.heapAllocations);
+  AppendValue (buffer, result.simulatedSeconds);
+  AppendValue (buffer, result.peakRssKb);
+  AppendValue (buffer, result.stopReason);
+  AppendValue (buffer, result.run);
+  AppendValue (buffer, result.queueDelayMean);
+  AppendValue (buffer, result.queueDelayMax);
+  AppendValue (buffer, result.queueBytesMean);
+  AppendValue (buffer, result.transfersStarted);
+  AppendValue (buffer, result.transfersCompleted);
+  AppendValue (buffer, result.fctP50);
+  AppendValue (buffer, result.fctP99);
+  AppendValue (buffer, result.fctP999);
+  AppendValue (buffer, result.slowdownMean);
+  AppendValue (buffer, result.slowdownP99);
+  AppendValue (buffer, result.delayPercentiles);
+  AppendValue (buffer, result.jitterPercentiles);
+  AppendValue (buffer, result.crossUdpThroughput);
+  AppendValue (buffer, result.crossTcpThroughput);
+  AppendValue (buffer, result.crossWebThroughput);
+  AppendValue (buffer, result.webTransfers);
+  AppendValue (buffer, result.webFctP99);
+  AppendValue (buffer, result.agentFairness);
+  return buffer;
+}
+
+
+bool DeserializeResult (const string &buffer, SweepResult &result)
+{
+  size_t offset = 0;
+  return ExtractValue (buffer, offset, result.segmentSize)
+         && ExtractValue (buffer, offset, result.throughput)
+         && ExtractValue (buffer, offset, result.fairness)
+         && ExtractValue (buffer, offset, result.goodput)
+         && ExtractVector (buffer, offset, result.flowMetrics)
+         && ExtractString (buffer, offset, result.flowRecords)
+         && ExtractValue (buffer, offset, result.events)
+         && ExtractValue (buffer, offset, result.wallSeconds)
+         && ExtractValue (buffer, offset, result.setupSeconds)
+         && ExtractValue (buffer, offset, result.routingSeconds)
+         && ExtractValue (buffer, offset, result.traceSamples)
+         && ExtractValue (buffer, offset, result.rejectedPackets)
+         && ExtractValue (buffer, offset, result.heapAllocations)
+         && ExtractValue (buffer, offset, result.simulatedSeconds)
+         && ExtractValue (buffer, offset, result.peakRssKb)
+         && ExtractValue (buffer, offset, result.stopReason)
+         && ExtractValue (buffer, offset, result.run)
+         && ExtractValue (buffer, offset, result.queueDelayMean)
+         && ExtractValue (buffer, offset, result.queueDelayMax)
+         && ExtractValue (buffer, offset, result.queueBytesMean)
+         && ExtractValue (buffer, offset, result.transfersStarted)
+         && ExtractValue (buffer, offset, result.transfersCompleted)
+         && ExtractValue (buffer, offset, result.fctP50)
+         && ExtractValue (buffer, offset, result.fctP99)
+         && ExtractValue (buffer, offset, result.fctP999)
+         && ExtractValue (buffer, offset, result.slowdownMean)
+         && ExtractValue (buffer, offset, result.slowdownP99)
+         && ExtractValue (buffer, offset, result.delayPercentiles)
+         && ExtractValue (buffer, offset, result.jitterPercentiles)
+         && ExtractValue (buffer, offset, result.crossUdpThroughput)
+         && ExtractValue (buffer, offset, result.crossTcpThroughput)
+         && ExtractValue (buffer, offset, result.crossWebThroughput)
+         && ExtractValue (buffer, offset, result.webTransfers)
+         && ExtractValue (buffer, offset, result.webFctP99)
+         && ExtractValue (buffer, offset, result.agentFairness)
+         && offset == buffer.size ();
 }
 
 
-// Start Application
-void SimulatorApp::StartApplication (void)
+// Everything that determines the outcome of one sweep point, one "name=value" per line.
+// Its hash names the cache entry; the text itself is stored with the entry and compared on load.
+string CacheKeyText (const SweepConfig &config, int segment_size)
 {
-  m_running = true;
-  m_packetsSent = 0;
-  if (InetSocketAddress::IsMatchingType (m_peer))
+  ostringstream key;
+  // every double round-trips, so configs that differ in any bit never share a key
+  key << setprecision (17);
+  key << "program=wireless\n"
+      << "binary=" << config.binaryHash << "\n"
+      << "agent=" << config.agent << "\n"
+      << "segment_size=" << segment_size << "\n"
+      << "backhaul_link=" << config.backhaulRate << "/" << config.backhaulDelay
+      << "/" << QueueLimit (config.backhaulRate, config.backhaulDelay, segment_size, config.queueBytes) << "\n"
+      << "app=" << config.appRate << "/" << config.packetsPerFlow << "\n"
+      << "cross=" << config.crossUdpLoad << "/" << config.crossWebLoad << "/" << config.webMeanBytes << "/" << config.crossTcp
+      << "/" << config.crossAgent << "/" << config.crossDelay << "\n"
+      << "workload=";
+  if (config.ftp)
+    {
+      key << "ftp/" << config.ftpSizes << "/" << config.ftpMeanBytes << "/" << config.ftpArrivalRate
+          << "/" << config.ftpTransfers << "\n";
+    }
+  else
+    {
+      key << "cbr\n";
+    }
+  key << "send_mode=" << (config.bulkSend ? "bulk" : "paced") << "\n"
+      << "reuse_payload=" << config.reusePayload << "\n"
+      << "scheduler=" << config.scheduler << "\n"
+      << "qdisc=" << config.qdisc << "\n"
+      << "routing=" << config.routing << "\n"
+      << "wifi=" << config.wifiStandard << "/" << config.channelWidth << "/" << config.wifiManager
+      << "/" << config.mcs << "/" << config.ampduBytes << "/" << config.amsduBytes << "\n"
+      << "stations=" << config.stations << "\n"
+      << "errors=" << config.errorRate << "/" << config.errorUnit << "/" << config.errorLink << "/" << config.retryLimit << "\n"
+      << "mobility=" << config.distance << "/" << config.mobility << "/" << config.walkSpeed << "\n"
+      << "delay_bin=" << config.delayBinWidth << "\n"
+      << "measure=" << (config.sinkMeasure ? "sink" : "flowmon") << "\n"
+      << "converge=";
+  if (config.converge)
     {
-      m_socket->Bind ();
+      key << config.convergeInterval << "/" << config.convergeWindow << "/" << config.convergeTolerance << "\n";
     }
   else
     {
-      m_socket->Bind6 ();
+      key << "off\n";
     }
-  m_socket->Connect (m_peer);
-  SendPacket ();
+  key << "seed=" << config.seed << "\n"
+      << "run=" << config.run << "\n";
+  return key.str ();
 }
 
 
-// Stop Application
-void SimulatorApp::StopApplication (void)
+// Sets the standard and rate control of the Wi-Fi links
+void ConfigureWifi (const SweepConfig &config, WifiHelper &wifi)
 {
-  m_running = false;
-
-  if (m_sendEvent.IsRunning ())
+  int standard = WifiStandardIndex (config.wifiStandard);
+  if (standard > 0)
     {
-      Simulator::Cancel (m_sendEvent);
+      wifi.SetStandard (WIFI_STANDARDS[standard]);
     }
-
-  if (m_socket)
+  if (config.wifiManager == "constant")
     {
-      m_socket->Close ();
+      wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                    "DataMode", StringValue (WifiModeName (config.wifiStandard, config.mcs)),
+                                    "ControlMode", StringValue ("OfdmRate24Mbps"));
+    }
+  else if (config.wifiManager == "minstrel")
+    {
+      wifi.SetRemoteStationManager (config.wifiStandard == "a" ? "ns3::MinstrelWifiManager" : "ns3::MinstrelHtWifiManager");
+    }
+  else
+    {
+      wifi.SetRemoteStationManager ("ns3::AarfWifiManager");
     }
 }
 
 
-// Sending and scheduling Packets
-void SimulatorApp::SendPacket (void)
+// PHY channel of the Wi-Fi links: {number, width, band, primary20}, 0 picking the default
+string WifiChannelSettings (const SweepConfig &config)
 {
-  Ptr<Packet> packet = Create<Packet> (m_packetSize);
-  m_socket->Send (packet);
+  return "{0, " + to_string (config.channelWidth) + ", BAND_5GHZ, 0}";
+}
 
-  if (++m_packetsSent < m_nPackets)
+
+// Applies the A-MPDU and A-MSDU limits of the best-effort queue to installed Wi-Fi devices
+void SetAggregation (const SweepConfig &config, const NetDeviceContainer &devices)
+{
+  for (uint32_t i = 0; i < devices.GetN (); i++)
     {
-      ScheduleTx ();
+      Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice> (devices.Get (i));
+      if (config.ampduBytes >= 0)
+        {
+          device->GetMac ()->SetAttribute ("BE_MaxAmpduSize", UintegerValue (config.ampduBytes));
+        }
+      if (config.amsduBytes >= 0)
+        {
+          device->GetMac ()->SetAttribute ("BE_MaxAmsduSize", UintegerValue (config.amsduBytes));
+        }
     }
 }
 
 
-// Packet Scheduler
-void SimulatorApp::ScheduleTx (void)
+// Position of station index of count in a cell: evenly spread on a circle of the given
+// radius around the base station
+Vector StationPosition (Vector baseStation, double radius, uint32_t index, uint32_t count)
+{
+  double angle = 2 * M_PI * index / count;
+  return Vector (baseStation.x + radius * cos (angle), baseStation.y + radius * sin (angle), baseStation.z);
+}
+
+
+// A RateErrorModel of its own for one receiving device
+Ptr<RateErrorModel> CreateErrorModel (const SweepConfig &config)
+{
+  Ptr<RateErrorModel> model = CreateObject<RateErrorModel> ();
+  model->SetRate (config.errorRate);
+  model->SetUnit (config.errorUnit == "bit" ? RateErrorModel::ERROR_UNIT_BIT : RateErrorModel::ERROR_UNIT_PACKET);
+  return model;
+}
+
+
+// Drops frames the PHYs of installed Wi-Fi devices received correctly, at the configured rate.
+// The MAC retransmits a lost frame at most retryLimit times, so that TCP sees part of the loss
+// instead of the 802.11 retries hiding all of it
+void SetWifiErrors (const SweepConfig &config, const NetDeviceContainer &devices)
 {
-  if (m_running)
+  for (uint32_t i = 0; i < devices.GetN (); i++)
     {
-      Time tNext (Seconds (m_packetSize * 8 / static_cast<double> (m_dataRate.GetBitRate ())));
-      m_sendEvent = Simulator::Schedule (tNext, &SimulatorApp::SendPacket, this);
+      Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice> (devices.Get (i));
+      device->GetPhy ()->SetPostReceptionErrorModel (CreateErrorModel (config));
+      device->GetRemoteStationManager ()->SetAttribute ("MaxSsrc", UintegerValue (config.retryLimit));
+      device->GetRemoteStationManager ()->SetAttribute ("MaxSlrc", UintegerValue (config.retryLimit));
     }
 }
 
+
+// One-line summary of the Wi-Fi setup for the sweep output
+string DescribeWifi (const SweepConfig &config)
+{
+  string standard = config.wifiStandard == "default" ? "default standard" : "802.11" + config.wifiStandard;
+  string width = config.channelWidth > 0 ? to_string (config.channelWidth) + " MHz" : "default width";
+  string manager = config.wifiManager == "constant" ? "constant " + WifiModeName (config.wifiStandard, config.mcs) : config.wifiManager;
+  string ampdu = config.ampduBytes < 0 ? "default" : config.ampduBytes == 0 ? "off" : to_string (config.ampduBytes) + " B";
+  string amsdu = config.amsduBytes < 0 ? "default" : config.amsduBytes == 0 ? "off" : to_string (config.amsduBytes) + " B";
+  string cells = config.stations > 1 ? ", " + to_string (config.stations) + " stations per cell" : "";
+  string retries = config.errorLink == "wifi" ? " (" + to_string (config.retryLimit) + " retries)" : "";
+  string errors = config.errorRate > 0 ? ", " + to_string (config.errorRate) + " " + config.errorUnit + " errors on " + config.errorLink + retries : "";
+  string placement = config.mobility == "walk" ? "walking at " + to_string (config.walkSpeed) + " m/s within " : "";
+  return standard + ", " + width + ", " + manager + ", A-MPDU " + ampdu + ", A-MSDU " + amsdu + cells + errors
+         + ", " + placement + to_string (config.distance) + " m";
+}
+
+
+// Runs a single (agent, segment size) point of the sweep
+SweepResult RunSweepPoint (const SweepConfig &config, int segment_size)
+{
+	auto setupStart = chrono::steady_clock::now ();
+	ResetPeakRss ();
+	RngSeedManager::SetSeed (config.seed);
+	RngSeedManager::SetRun (config.run);
+	
+	//selecting the event scheduler
+	ObjectFactory schedulerFactory;
+	schedulerFactory.SetTypeId (SchedulerTypeName (config.scheduler));
+	Simulator::SetScheduler (schedulerFactory);
+	
+	//setting socket type (according to TCP-agent) and segment size
+	Config::SetDefault ("ns3::TcpL4Protocol::SocketType", StringValue (AgentTypeName (config.agent)));
+	Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (segment_size));	
+	
+	
+	//creating nodes: the two base stations and the hosts of their cells, station i of the
+	//first cell sending to station i of the second
+	NodeContainer baseStations, senders, receivers;
+	baseStations.Create(2);
+	senders.Create(config.stations);
+	receivers.Create(config.stations);
+	
+	//creating wired-links
+	PointToPointHelper BaseToBase;
+  	BaseToBase.SetDeviceAttribute ("DataRate", StringValue (config.backhaulRate));
+  	BaseToBase.SetChannelAttribute ("Delay", StringValue (config.backhaulDelay));
+  	//with a queue disc the device queue is kept to one packet, so that the queue builds up in the queue disc
+  	string backhaulLimit = QueueLimit (config.backhaulRate, config.backhaulDelay, segment_size, config.queueBytes);
+  	string qdiscType = QueueDiscTypeName (config.qdisc);
+  	BaseToBase.SetQueue("ns3::DropTailQueue<Packet>", "MaxSize", StringValue(qdiscType.empty() ? backhaulLimit : "1p"));
+  	
+  	  		
+  	
+  	//setting up wired-links between base-stations
+  	NetDeviceContainer path_BS1BS2;
+  	path_BS1BS2 = BaseToBase.Install( baseStations.Get(0), baseStations.Get(1));
+  	
+  	
+  	//setting up wireless-links between host and base-station
+  	YansWifiChannelHelper N0BS1 = YansWifiChannelHelper::Default ();
+  	YansWifiPhyHelper phy_N0BS1;
+  	phy_N0BS1.SetChannel (N0BS1.Create ());
+  	
+  	YansWifiChannelHelper N1BS2 = YansWifiChannelHelper::Default ();
+  	YansWifiPhyHelper phy_N1BS2;
+  	phy_N1BS2.SetChannel (N1BS2.Create ());
+  	if(config.wifiStandard!="default")
+  	{
+  		phy_N0BS1.Set ("ChannelSettings", StringValue (WifiChannelSettings (config)));
+  		phy_N1BS2.Set ("ChannelSettings", StringValue (WifiChannelSettings (config)));
+  	}
+  	
+  	// creating and setting wifi
+  	WifiHelper wifi;
+  	ConfigureWifi (config, wifi);
+
+  	WifiMacHelper mac;
+  	Ssid ssid = Ssid ("ns-3-ssid");
+  	
+  	
+  	//installing wifi on basestations, the access points of the two cells
+  	mac.SetType ("ns3::ApWifiMac",
+               	"Ssid", SsidValue (ssid));
+  	NetDeviceContainer accessPoint_BS1, accessPoint_BS2;
+  	accessPoint_BS1 = wifi.Install(phy_N0BS1, mac, baseStations.Get(0));
+  	accessPoint_BS2 = wifi.Install(phy_N1BS2, mac, baseStations.Get(1));
+  	
+  	
+  	// installing wifi on hosts, which associate with the base station of their cell
+  	mac.SetType ("ns3::StaWifiMac",
+               	"Ssid", SsidValue (ssid),
+               	"ActiveProbing", BooleanValue (false));
+  	NetDeviceContainer endPoint_N0, endPoint_N1;
+  	endPoint_N0 = wifi.Install (phy_N0BS1, mac, senders);
+  	endPoint_N1 = wifi.Install (phy_N1BS2, mac, receivers);
+  	
+  	//frame aggregation limits on all Wi-Fi devices
+  	SetAggregation (config, accessPoint_BS1);
+  	SetAggregation (config, accessPoint_BS2);
+  	SetAggregation (config, endPoint_N0);
+  	SetAggregation (config, endPoint_N1);
+  	
+  	//random losses, on both ends of the backhaul or on the Wi-Fi receptions of both cells; the
+  	//Wi-Fi ones start with the applications, once the stations have associated
+  	if(config.errorRate>0 && config.errorLink=="wifi")
+  	{
+  		Simulator::Schedule (Seconds (1.), &SetWifiErrors, config, accessPoint_BS1);
+  		Simulator::Schedule (Seconds (1.), &SetWifiErrors, config, accessPoint_BS2);
+  		Simulator::Schedule (Seconds (1.), &SetWifiErrors, config, endPoint_N0);
+  		Simulator::Schedule (Seconds (1.), &SetWifiErrors, config, endPoint_N1);
+  	}
+  	else if(config.errorRate>0)
+  	{
+  		DynamicCast<PointToPointNetDevice> (path_BS1BS2.Get (0))->SetReceiveErrorModel (CreateErrorModel (config));
+  		DynamicCast<PointToPointNetDevice> (path_BS1BS2.Get (1))->SetReceiveErrorModel (CreateErrorModel (config));
+  	}
+  	
+  	
+  	// Setting wireless links between hosts and basestations, the base station first
+  	NetDeviceContainer path_N0BS1(accessPoint_BS1, endPoint_N0);
+  	NetDeviceContainer path_N1BS2(accessPoint_BS2, endPoint_N1);        
+  	
+  	
+  	//Setting positions of devices: the base stations 5 m apart, their stations around them at
+  	//the configured distance (the two cells are on channels of their own, so they do not interfere)
+  	MobilityHelper mobility;
+  	Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator> ();
+  	Vector positionBS1 (5.0, 0.0, 0.0), positionBS2 (10.0, 0.0, 0.0);
+  	positions->Add (positionBS1);
+  	positions->Add (positionBS2);
+  	for(uint32_t i=0;i<config.stations;i++)
+  		positions->Add (StationPosition (positionBS1, config.distance, i, config.stations));
+  	for(uint32_t i=0;i<config.stations;i++)
+  		positions->Add (StationPosition (positionBS2, config.distance, i, config.stations));
+  	mobility.SetPositionAllocator (positions);
+
+               mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+               
+         	mobility.Install(baseStations);
+  	//walking stations head for one random point after another, drawn uniformly from the disc of
+  	//the distance around their base station; the disc is convex, so no station ever gets farther
+  	if(config.mobility=="walk")
+  	{
+  		Ptr<UniformDiscPositionAllocator> waypoints_BS1 = CreateObject<UniformDiscPositionAllocator> ();
+  		waypoints_BS1->SetAttribute ("rho", DoubleValue (config.distance));
+  		waypoints_BS1->SetAttribute ("X", DoubleValue (positionBS1.x));
+  		waypoints_BS1->SetAttribute ("Y", DoubleValue (positionBS1.y));
+  		mobility.SetMobilityModel ("ns3::RandomWaypointMobilityModel",
+  						"Speed", StringValue ("ns3::ConstantRandomVariable[Constant="+ to_string(config.walkSpeed) +"]"),
+  						"Pause", StringValue ("ns3::ConstantRandomVariable[Constant=0.0]"),
+  						"PositionAllocator", PointerValue (waypoints_BS1));
+  		mobility.Install(senders);
+  		Ptr<UniformDiscPositionAllocator> waypoints_BS2 = CreateObject<UniformDiscPositionAllocator> ();
+  		waypoints_BS2->SetAttribute ("rho", DoubleValue (config.distance));
+  		waypoints_BS2->SetAttribute ("X", DoubleValue (positionBS2.x));
+  		waypoints_BS2->SetAttribute ("Y", DoubleValue (positionBS2.y));
+  		mobility.SetMobilityModel ("ns3::RandomWaypointMobilityModel",
+  						"Speed", StringValue ("ns3::ConstantRandomVariable[Constant="+ to_string(config.walkSpeed) +"]"),
+  						"Pause", StringValue ("ns3::ConstantRandomVariable[Constant=0.0]"),
+  						"PositionAllocator", PointerValue (waypoints_BS2));
+  		mobility.Install(receivers);
+  	}
+  	else
+  	{
+    	 	mobility.Install(senders);
+    		mobility.Install(receivers);
+  	}
+
+               
+  	//building Internet stack
+  	InternetStackHelper stack;
+  	Ipv4NixVectorHelper nixRouting;
+  	Ipv4StaticRoutingHelper staticRouting;
+  	if(config.routing=="nix")
+  		stack.SetRoutingHelper (nixRouting);
+  	else if(config.routing=="static")
+  		stack.SetRoutingHelper (staticRouting);
+  	stack.Install(baseStations);
+  	stack.Install(senders);
+  	stack.Install(receivers);
+  	
+  	
+  	//assigning Ip addresses
+  	Ipv4AddressHelper ipv4_N0BS1;
+	      	ipv4_N0BS1.SetBase( "10.1.1.0" , "255.255.255.0" );
+	      	Ipv4InterfaceContainer N0BS1Interface = ipv4_N0BS1.Assign (path_N0BS1);
+
+	      	Ipv4AddressHelper ipv4_BS1BS2;
+	      	ipv4_BS1BS2.SetBase( "10.1.2.0" , "255.255.255.0" );
+	      	Ipv4InterfaceContainer BS1BS2Interface = ipv4_BS1BS2.Assign (path_BS1BS2);
+	      	
+	      	//replacing the queue disc the address helper installed on the base station interfaces
+	      	TrafficControlHelper trafficControl;
+	      	QueueDiscContainer backhaulQueueDiscs;
+	      	if(config.qdisc!="default")
+	      		trafficControl.Uninstall (path_BS1BS2);
+	      	if(!qdiscType.empty())
+	      	{
+	      		trafficControl.SetRootQueueDisc (qdiscType, "MaxSize", QueueSizeValue (QueueSize (backhaulLimit)));
+	      		backhaulQueueDiscs = trafficControl.Install (path_BS1BS2);
+	      	}
+	      	
+	      	//tracing the queue the data leaves the first base station through
+	      	QueueMonitor queueMonitor (config.queueTrace ? "wireless_TCP_"+config.agent+"_"+to_string(segment_size)+".queue" : "", config.traceBuffer);
+	      	if(!qdiscType.empty())
+	      		queueMonitor.WatchQueueDisc (backhaulQueueDiscs.Get (0));
+	      	else
+	      		queueMonitor.WatchDeviceQueue (DynamicCast<PointToPointNetDevice> (path_BS1BS2.Get (0))->GetQueue ());
+
+	      	Ipv4AddressHelper ipv4_N1BS2;
+	      	ipv4_N1BS2.SetBase( "10.1.3.0" , "255.255.255.0" );
+	      	Ipv4InterfaceContainer N1BS2Interface = ipv4_N1BS2.Assign (path_N1BS2);
+	      	
+	      	//cross traffic across the backhaul, from hosts of its own at the two base stations
+	      	unique_ptr<CrossTraffic> crossTraffic;
+	      	vector<pair<Ptr<NetDevice>, Ipv4Address> > crossRoutes;
+	      	if(HasCrossTraffic (config))
+	      	{
+	      		double baseRtt = 2*(2*Time (config.crossDelay).GetSeconds ()+Time (config.backhaulDelay).GetSeconds ());
+	      		crossTraffic.reset (new CrossTraffic (config, DataRate (config.backhaulRate).GetBitRate (), Seconds (baseRtt)));
+	      		crossTraffic->Install (baseStations.Get (0), baseStations.Get (1), stack, "10.1.4.0", "255.255.255.0", crossRoutes);
+	      	}
+	      	
+	      	
+	      	//Assigning port Number;
+	      	uint16_t sinkPort = 9897;
+
+	
+      		Address anyAddress = InetSocketAddress (Ipv4Address::GetAny (), sinkPort);
+      		//Creating application container, one sink on every receiving station
+      		PacketSinkHelper packetSinkHelper ("ns3::TcpSocketFactory", anyAddress);
+      		ApplicationContainer sinkApps = packetSinkHelper.Install (receivers);
+      		//file transfers are timed against an ideal one at the base RTT and the backhaul rate
+      		unique_ptr<TransferTracker> transferTracker;
+      		if(config.ftp)
+      			transferTracker.reset (new TransferTracker (DataRate (config.backhaulRate).GetBitRate (), Seconds (2*Time (config.backhaulDelay).GetSeconds ())));
+      		unique_ptr<TimeSeriesSampler> sampler;
+      		if(config.trace)
+      			sampler.reset (new TimeSeriesSampler ("wireless_TCP_"+config.agent+"_"+to_string(segment_size)+".ts", config.stations, Seconds (config.traceInterval), config.traceBuffer));
+      		unique_ptr<ConvergenceMonitor> monitor;
+      		if(config.converge)
+      			monitor.reset (new ConvergenceMonitor (Seconds (config.convergeInterval), config.convergeWindow, config.convergeTolerance));
+      		for(uint32_t i=0;i<config.stations;i++)
+      		{
+      			if(transferTracker)
+      				transferTracker->WatchSink (sinkApps.Get (i));
+      			if(sampler)
+      				sampler->WatchSink (i, sinkApps.Get (i));
+      			if(monitor)
+      				monitor->WatchSink (sinkApps.Get (i));
+      		}
+      		//Set the start and stop times for the server-side
+      		sinkApps.Start (Seconds (0.));
+  	sinkApps.Stop (Seconds (20.));
+
+
+      		//the senders start once the stations have associated with their base station
+      		vector<Ptr<SimulatorApp> > senderApps;
+      		for(uint32_t i=0;i<config.stations;i++)
+      		{
+      			Address sinkAddress = InetSocketAddress (N1BS2Interface.GetAddress (i+1), sinkPort);
+      			if(config.ftp)
+      			{
+      				Ptr<FileTransferApp> ftpApp = CreateObject<FileTransferApp> ();
+      				ftpApp->Setup (sinkAddress, transferTracker.get (), FileSizeStream (config), TransferGapStream (config), config.ftpTransfers);
+      				senders.Get(i)->AddApplication(ftpApp);
+      				ftpApp->SetStartTime (Seconds (1.));
+      				ftpApp->SetStopTime (Seconds (20.));
+      				continue;
+      			}
+      			
+      			// Create a client socket
+      			Ptr<Socket> ns3TcpSocket = Socket::CreateSocket (senders.Get (i), TcpSocketFactory::GetTypeId ());
+      			if(sampler)
+      				sampler->WatchSender (i, ns3TcpSocket);
+      			//Create an Application
+      			Ptr<SimulatorApp> simulApp = CreateObject<SimulatorApp> ();
+      			simulApp->Setup(ns3TcpSocket, sinkAddress, segment_size, config.packetsPerFlow, DataRate (config.appRate), config.bulkSend);
+      			simulApp->SetPayloadReuse (config.reusePayload);
+      			senders.Get(i)->AddApplication(simulApp);
+      			senderApps.push_back (simulApp);
+      			if(monitor)
+      				monitor->WatchSender (simulApp);
+      			//Set the start and stop times for the client-side
+      			simulApp->SetStartTime (Seconds (1.));
+      			simulApp->SetStopTime (Seconds (20.));
+      		}
+
+
+	//populating routing tables: global routing runs SPF from every node, nix-vector routing
+	//computes a path per destination on first use (during the run), and the static routes
+	//point every station at its base station and each base station at the other one
+	auto routingStart = chrono::steady_clock::now ();
+	if(config.routing=="global")
+		Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+	else if(config.routing=="static")
+	{
+		for(uint32_t i=0;i<config.stations;i++)
+		{
+			AddDefaultRoute (endPoint_N0.Get (i), N0BS1Interface.GetAddress (0));
+			AddDefaultRoute (endPoint_N1.Get (i), N1BS2Interface.GetAddress (0));
+		}
+		AddDefaultRoute (path_BS1BS2.Get (0), BS1BS2Interface.GetAddress (1));
+		AddDefaultRoute (path_BS1BS2.Get (1), BS1BS2Interface.GetAddress (0));
+		for(size_t i=0;i<crossRoutes.size();i++)
+			AddDefaultRoute (crossRoutes[i].first, crossRoutes[i].second);
+	}
+	double routingSeconds = chrono::duration<double> (chrono::steady_clock::now () - routingStart).count ();
+      		
+
+	//Flow monitor, or in the sink measurement mode constant-memory counters on the hosts
+	Ptr<FlowMonitor> flowMonitor;
+	FlowMonitorHelper flowHelper;
+	DelaySketch delaySketch, jitterSketch;
+	vector<FlowMeter> flowMeters;
+	if(config.sinkMeasure)
+	{
+		flowMeters.assign (config.stations, FlowMeter (&delaySketch, &jitterSketch));
+		for(uint32_t i=0;i<config.stations;i++)
+		{
+			flowMeters[i].WatchSender (senders.Get (i));
+			flowMeters[i].WatchReceiver (receivers.Get (i));
+		}
+	}
+	else
+	{
+		flowHelper.SetMonitorAttribute ("DelayBinWidth", DoubleValue (config.delayBinWidth));
+		flowHelper.SetMonitorAttribute ("JitterBinWidth", DoubleValue (config.delayBinWidth));
+		flowMonitor = flowHelper.InstallAll();
+	}
+	
+	if(sampler)
+		sampler->Start (Seconds (0.));
+	if(monitor)
+		monitor->Start (Seconds (0.));
+	
+	Simulator::Stop (Seconds (20));
+	auto wallStart = chrono::steady_clock::now ();
+	double setupSeconds = chrono::duration<double> (wallStart - setupStart).count ();
+	uint64_t allocationsBefore = g_heapAllocations.load (memory_order_relaxed);
+  	Simulator::Run ();
+  	uint64_t heapAllocations = g_heapAllocations.load (memory_order_relaxed) - allocationsBefore;
+  	double simulatedSeconds = Simulator::Now ().GetSeconds ();
+  	uint64_t traceSamples = sampler ? sampler->Finish () : 0;
+  	queueMonitor.Finish ();
+  	double wallSeconds = chrono::duration<double> (chrono::steady_clock::now () - wallStart).count ();
+  	
+  	//Obtaining per-station statistics
+  	vector<FlowMetrics> flowMetrics (config.stations, FlowMetrics ());
+  	vector<uint64_t> sinkBytes (config.stations, 0);
+  	for(uint32_t i=0;i<config.stations;i++)
+  	{
+  		flowMetrics[i].flow = i;
+  		sinkBytes[i] = DynamicCast<PacketSink> (sinkApps.Get (i))->GetTotalRx ();
+  	}
+  	string flowRecords;
+  	vector<uint64_t> delayBins, jitterBins;
+  	if(config.sinkMeasure)
+  	{
+  		for(uint32_t i=0;i<config.stations;i++)
+  			flowMeters[i].Record (flowMetrics[i], sinkBytes[i]);
+  	}
+  	else
+  	{
+  		// Output the data in xml format
+  		if(config.writeXml)
+  			flowMonitor->SerializeToXmlFile("wireless_TCP_"+config.agent+"_"+std::to_string(segment_size)+".xml", true, true);
+  		
+  		//FlowMonitor also sees the ACK flows back from the sinks: data flows go to the sink port,
+  		//and the receiving station's address tells which station pair a flow belongs to
+  		Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier> (flowHelper.GetClassifier ());
+  		flowRecords = EncodeFlowRecords (config.agent, segment_size, flowMonitor, classifier);
+  		map<uint32_t, uint32_t> flowOfReceiver;
+  		for(uint32_t i=0;i<config.stations;i++)
+  			flowOfReceiver[N1BS2Interface.GetAddress (i+1).Get ()] = i;
+  		for(auto statistics=flowMonitor->GetFlowStats().begin();statistics!=flowMonitor->GetFlowStats().end();statistics++)
+  		{
+  			Ipv4FlowClassifier::FiveTuple tuple = classifier->FindFlow (statistics->first);
+  			if(tuple.destinationPort==sinkPort)
+  			{
+  				AddHistogram (delayBins, statistics->second.delayHistogram);
+  				AddHistogram (jitterBins, statistics->second.jitterHistogram);
+  				auto receiver = flowOfReceiver.find (tuple.destinationAddress.Get ());
+  				if(receiver!=flowOfReceiver.end())
+  					RecordDataFlow (flowMetrics[receiver->second], statistics->second, sinkBytes[receiver->second]);
+  			}
+  			else if(tuple.sourcePort==sinkPort)
+  			{
+  				auto receiver = flowOfReceiver.find (tuple.sourceAddress.Get ());
+  				if(receiver!=flowOfReceiver.end())
+  					RecordAckFlow (flowMetrics[receiver->second], statistics->second);
+  			}
+  		}
+  	}
+  	
+  	//aggregate throughput of the cell, and the fairness between its stations
+  	double sumThroughput=0;
+  	double sumSqThroughput=0;
+  	double goodput=0;
+  	int n=0;
+  	
+  	for(size_t i=0;i<flowMetrics.size();i++)
+  	{
+  		sumThroughput += flowMetrics[i].throughput;
+  		sumSqThroughput += flowMetrics[i].throughput*flowMetrics[i].throughput;
+  		goodput += flowMetrics[i].goodput;
+  		n++;
+  	}
+  	
+  	double jain_fairness = sumSqThroughput>0 ? (sumThroughput*sumThroughput)/((n+0.0)*sumSqThroughput) : 0;
+  	uint64_t events = Simulator::GetEventCount ();
+  	uint64_t rejectedPackets = 0;
+  	for(size_t i=0;i<senderApps.size();i++)
+  		rejectedPackets += senderApps[i]->GetPacketsRejected ();
+  	
+  	
+  	Simulator::Destroy ();
+  	
+  	SweepResult result;
+  	result.segmentSize = segment_size;
+  	result.throughput = sumThroughput;
+  	result.fairness = jain_fairness;
+  	result.goodput = goodput;
+  	result.flowMetrics = flowMetrics;
+  	result.flowRecords = flowRecords;
+  	result.events = events;
+  	result.wallSeconds = wallSeconds;
+  	result.setupSeconds = setupSeconds;
+  	result.routingSeconds = routingSeconds;
+  	result.traceSamples = traceSamples;
+  	result.rejectedPackets = rejectedPackets;
+  	result.heapAllocations = heapAllocations;
+  	result.simulatedSeconds = simulatedSeconds;
+  	result.peakRssKb = PeakRssKb ();
+  	result.stopReason = monitor ? monitor->GetReason () : STOP_FULL_LENGTH;
+  	result.run = config.run;
+  	result.queueDelayMean = queueMonitor.GetMeanSojourn ();
+  	result.queueDelayMax = queueMonitor.GetMaxSojourn ();
+  	result.queueBytesMean = queueMonitor.GetMeanBytes ();
+  	RecordTransfers (result, transferTracker.get ());
+  	for(int q=0;q<4;q++)
+  	{
+  		result.delayPercentiles[q] = config.sinkMeasure ? delaySketch.Quantile (LATENCY_QUANTILES[q]) : HistogramPercentile (delayBins, config.delayBinWidth, LATENCY_QUANTILES[q]);
+  		result.jitterPercentiles[q] = config.sinkMeasure ? jitterSketch.Quantile (LATENCY_QUANTILES[q]) : HistogramPercentile (jitterBins, config.delayBinWidth, LATENCY_QUANTILES[q]);
+  	}
+  	result.crossUdpThroughput = 0;
+  	result.crossTcpThroughput = 0;
+  	result.crossWebThroughput = 0;
+  	result.webTransfers = 0;
+  	result.webFctP99 = 0;
+  	result.agentFairness = 0;
+  	if(crossTraffic)
+  	{
+  		vector<double> goodputs;
+  		for(size_t i=0;i<flowMetrics.size();i++)
+  			goodputs.push_back (flowMetrics[i].goodput);
+  		crossTraffic->Record (result, goodputs);
+  	}
+  	result.cached = false;
+  	return result;
+}
+
+
+// Compares the throughput of every point with and without frame aggregation
+void PrintAggregationGain (const vector<SweepResult> &aggregated, const vector<SweepResult> &plain)
+{
+	NS_LOG_INFO("+----------------------------------------------------------------+");
+	NS_LOG_INFO("|Packet Size  |  Throughput aggregated / plain (Kbps)  |   Gain   |");
+	NS_LOG_INFO("+----------------------------------------------------------------+");
+	for(size_t i=0;i<aggregated.size();i++)
+	{
+		double gain = plain[i].throughput>0 ? 100*(aggregated[i].throughput/plain[i].throughput-1) : 0;
+		NS_LOG_INFO("|    "+ to_string(aggregated[i].segmentSize) +"     |   "+ to_string(aggregated[i].throughput) +" / "+ to_string(plain[i].throughput) +"   |   "+ to_string(gain) +"%   |");
+	}
+	NS_LOG_INFO("+----------------------------------------------------------------+");
+}
+
+
+// Prints how the measured flows share the backhaul with the cross traffic
+void PrintCrossTrafficReport (const SweepConfig &config, const vector<SweepResult> &results)
+{
+	NS_LOG_INFO("Cross traffic: "+ DescribeCrossTraffic (config));
+	NS_LOG_INFO("+-----------------------------------------------------------------------------------------------------------------------------------+");
+	NS_LOG_INFO("|Packet Size  |   Throughput   | p99 Delay (ms) |  UDP (Kbps)  | Competing TCP (Kbps) |  Web (Kbps)  | Inter-agent Fairness | Web p99 FCT (s) |");
+	NS_LOG_INFO("+-----------------------------------------------------------------------------------------------------------------------------------+");
+	for(size_t i=0;i<results.size();i++)
+	{
+		NS_LOG_INFO("|    "+ to_string(results[i].segmentSize) +"     |   "+ to_string(results[i].throughput) +"   |   "+ to_string(1000*results[i].delayPercentiles[2]) +"   |   "+ to_string(results[i].crossUdpThroughput)
+			+"   |   "+ to_string(results[i].crossTcpThroughput) +"   |   "+ to_string(results[i].crossWebThroughput) +"   |   "+ to_string(results[i].agentFairness) +"   |   "+ to_string(results[i].webFctP99) +"   |");
+	}
+	NS_LOG_INFO("+-----------------------------------------------------------------------------------------------------------------------------------+");
+}
+
+
+// Runs one packet size with the station count per cell doubling from 1 up to the configured
+// one, one point after another so that the wall times are comparable, and reports how the
+// aggregate throughput, the fairness between stations and the simulation cost grow
+void RunStationScaling (const SweepConfig &config, int segment_size)
+{
+	vector<uint32_t> counts;
+	for(uint32_t stations=1;stations<config.stations;stations*=2)
+		counts.push_back (stations);
+	counts.push_back (config.stations);
+	
+	ofstream scalingFile(("wireless_TCP_"+config.agent+"_scaling.csv").c_str());
+	scalingFile << "agent,segment_size,stations,throughput_kbps,goodput_kbps,fairness,min_station_kbps,max_station_kbps,events,wall_seconds,events_per_sec,peak_rss_kb\n";
+	
+	NS_LOG_INFO("Station scaling - packet size "+ to_string(segment_size));
+	NS_LOG_INFO("+-------------------------------------------------------------------------------------------------------------------------+");
+	NS_LOG_INFO("|  Stations  |   Throughput   |  Fairness Index  | Min Station (Kbps) | Max Station (Kbps) |  Wall (s)  |  Events/sec  | Peak RSS (KB) |");
+	NS_LOG_INFO("+-------------------------------------------------------------------------------------------------------------------------+");
+	for(size_t i=0;i<counts.size();i++)
+	{
+		SweepConfig point = config;
+		point.stations = counts[i];
+		point.isolatePoints = true;
+		point.writeXml = false;
+		point.trace = false;
+		SweepResult result = RunSweep (point, vector<int> (1, segment_size), 1)[0];
+		
+		double minStation = result.flowMetrics.empty () ? 0 : result.flowMetrics[0].throughput;
+		double maxStation = minStation;
+		for(size_t f=1;f<result.flowMetrics.size();f++)
+		{
+			minStation = min (minStation, result.flowMetrics[f].throughput);
+			maxStation = max (maxStation, result.flowMetrics[f].throughput);
+		}
+		uint64_t events_per_sec = result.wallSeconds>0 ? result.events/result.wallSeconds : 0;
+		NS_LOG_INFO("|    "+ to_string(counts[i]) +"    |   "+ to_string(result.throughput) +"   |   "+ to_string(result.fairness) +"   |   "+ to_string(minStation) +"   |   "+ to_string(maxStation)
+			+"   |   "+ to_string(result.wallSeconds) +"   |   "+ to_string(events_per_sec) +"   |   "+ to_string(result.peakRssKb) +"   |");
+		scalingFile << config.agent << "," << segment_size << "," << counts[i] << "," << result.throughput << "," << result.goodput << "," << result.fairness << ","
+			<< minStation << "," << maxStation << "," << result.events << "," << result.wallSeconds << "," << events_per_sec << "," << result.peakRssKb << "\n";
+	}
+	NS_LOG_INFO("+-------------------------------------------------------------------------------------------------------------------------+");
+}
+
+
+// Runs one packet size for every agent at every value of a channel parameter, the error
+// rate ("loss") or the station distance ("distance"), all points in one worker pool, and
+// writes one throughput curve per agent
+void RunAgentSweep (const SweepConfig &config, int segment_size, string parameter, const vector<double> &values, int jobs)
+{
+	vector<SweepConfig> points;
+	for(int a=0;a<AGENT_COUNT;a++)
+	{
+		for(size_t v=0;v<values.size();v++)
+		{
+			SweepConfig point = config;
+			point.agent = AGENT_NAMES[a];
+			point.writeXml = false;
+			point.trace = false;
+			if(parameter=="loss")
+				point.errorRate = values[v];
+			else
+				point.distance = values[v];
+			points.push_back (point);
+		}
+	}
+	vector<SweepResult> results = RunPoints (points, vector<int> (points.size (), segment_size), jobs);
+	
+	string column = parameter=="loss" ? config.errorUnit+" error rate" : "distance (m)";
+	ofstream sweepFile(("wireless_TCP_"+parameter+".csv").c_str());
+	sweepFile << "agent,segment_size," << (parameter=="loss" ? "error_rate" : "distance_m") << ",tcp_visible_loss,throughput_kbps,goodput_kbps,fairness,p99_delay_s\n";
+	
+	Gnuplot plot ("Wireless_TCP_"+parameter+".png");
+	plot.SetTitle ("Throughput vs "+ column +" ("+ to_string(segment_size) +" B packets, "+ DescribeWifi (config) +")");
+	plot.SetTerminal ("png");
+	plot.SetLegend (parameter=="loss" ? "Error rate" : "Distance (in m)", "Throughput (in Kbps)");
+	
+	NS_LOG_INFO("Agent sweep over the "+ column +" - packet size "+ to_string(segment_size));
+	NS_LOG_INFO("+--------------------------------------------------------------------------------------------------------------+");
+	NS_LOG_INFO("|   Agent   |   "+ column +"   |  TCP-visible Loss  |   Throughput   |    Goodput    |  Fairness Index  | p99 Delay (ms) |");
+	NS_LOG_INFO("+--------------------------------------------------------------------------------------------------------------+");
+	for(int a=0;a<AGENT_COUNT;a++)
+	{
+		Gnuplot2dDataset dataset;
+		dataset.SetTitle ("TCP-"+ string(AGENT_NAMES[a]));
+		dataset.SetStyle (Gnuplot2dDataset::LINES_POINTS);
+		for(size_t v=0;v<values.size();v++)
+		{
+			const SweepResult &result = results[a*values.size()+v];
+			//loss of the data packets at the IP layer, after any MAC retries, over all stations
+			double lossRate = 0;
+			for(size_t f=0;f<result.flowMetrics.size();f++)
+				lossRate += result.flowMetrics[f].lossRate/result.flowMetrics.size();
+			NS_LOG_INFO("|  "+ string(AGENT_NAMES[a]) +"  |   "+ to_string(values[v]) +"   |   "+ to_string(lossRate) +"   |   "+ to_string(result.throughput)
+				+"   |   "+ to_string(result.goodput) +"   |   "+ to_string(result.fairness) +"   |   "+ to_string(1000*result.delayPercentiles[2]) +"   |"+ (result.cached ? "  (cached)" : ""));
+			sweepFile << AGENT_NAMES[a] << "," << segment_size << "," << values[v] << "," << lossRate << "," << result.throughput << ","
+				<< result.goodput << "," << result.fairness << "," << result.delayPercentiles[2] << "\n";
+			dataset.Add (values[v], result.throughput);
+		}
+		plot.AddDataset (dataset);
+	}
+	NS_LOG_INFO("+--------------------------------------------------------------------------------------------------------------+");
+	
+	ofstream plotFile (("Wireless_TCP_"+parameter+".plt").c_str());
+	plot.GenerateOutput (plotFile);
+}
+
+
+// Runs one packet size at every load level of one kind of cross traffic (udp or web), all
+// points in one worker pool, and reports how the measured flows fare as the load grows
+void RunLoadSweep (const SweepConfig &config, int segment_size, string kind, const vector<double> &loads, int jobs)
+{
+	vector<SweepConfig> points;
+	for(size_t l=0;l<loads.size();l++)
+	{
+		SweepConfig point = config;
+		point.writeXml = false;
+		point.trace = false;
+		if(kind=="web")
+			point.crossWebLoad = loads[l];
+		else
+			point.crossUdpLoad = loads[l];
+		points.push_back (point);
+	}
+	vector<SweepResult> results = RunPoints (points, vector<int> (points.size (), segment_size), jobs);
+	
+	ofstream loadFile(("wireless_TCP_"+config.agent+"_load.csv").c_str());
+	loadFile << "agent,segment_size,load_kind,load,throughput_kbps,goodput_kbps,p99_delay_s,cross_udp_kbps,cross_tcp_kbps,cross_web_kbps,agent_fairness,web_transfers,web_fct_p99_s\n";
+	
+	NS_LOG_INFO("Load sweep of the "+ kind +" cross traffic - packet size "+ to_string(segment_size) +" ("+ DescribeCrossTraffic (config) +")");
+	NS_LOG_INFO("+-----------------------------------------------------------------------------------------------------------------------------------+");
+	NS_LOG_INFO("|   Load   |   Throughput   |    Goodput    | p99 Delay (ms) | Cross (Kbps) | Competing TCP (Kbps) | Inter-agent Fairness | Web p99 FCT (s) |");
+	NS_LOG_INFO("+-----------------------------------------------------------------------------------------------------------------------------------+");
+	for(size_t l=0;l<loads.size();l++)
+	{
+		const SweepResult &result = results[l];
+		double cross = result.crossUdpThroughput + result.crossTcpThroughput + result.crossWebThroughput;
+		NS_LOG_INFO("|   "+ to_string(loads[l]) +"   |   "+ to_string(result.throughput) +"   |   "+ to_string(result.goodput) +"   |   "+ to_string(1000*result.delayPercentiles[2]) +"   |   "+ to_string(cross)
+			+"   |   "+ to_string(result.crossTcpThroughput) +"   |   "+ to_string(result.agentFairness) +"   |   "+ to_string(result.webFctP99) +"   |"+ (result.cached ? "  (cached)" : ""));
+		loadFile << config.agent << "," << segment_size << "," << kind << "," << loads[l] << "," << result.throughput << "," << result.goodput << "," << result.delayPercentiles[2] << ","
+			<< result.crossUdpThroughput << "," << result.crossTcpThroughput << "," << result.crossWebThroughput << "," << result.agentFairness << ","
+			<< result.webTransfers << "," << result.webFctP99 << "\n";
+	}
+	NS_LOG_INFO("+-----------------------------------------------------------------------------------------------------------------------------------+");
+}
+
+
 int main(int argc, char *argv[])
 {
 	
@@ -143,39 +1106,379 @@ int main(int argc, char *argv[])
 	//obtaining TCP agent
 	string socket_type;
 	CommandLine cmd;
+	int jobs = 1;
+	bool write_xml = false;
+	bool trace = false;
+	double trace_interval = 0.01;
+	uint32_t trace_buffer = 65536;
+	bool trace_benchmark = false;
+	bool converge = false;
+	double converge_interval = 0.2;
+	uint32_t converge_window = 10;
+	double converge_tolerance = 0.02;
+	bool converge_check = false;
+	uint32_t replications = 1;
+	bool crn = false;
+	string qdisc = "default";
+	string queue_unit = "packets";
+	bool queue_trace = false;
+	double delay_bin = 0.001;
+	string measure = "flowmon";
+	bool measure_benchmark = false;
+	string workload = "cbr";
+	string ftp_sizes = "fixed";
+	double ftp_mean = 1000000;
+	double ftp_rate = 0;
+	uint32_t ftp_transfers = 20;
+	string send_mode = "paced";
+	bool send_benchmark = false;
+	bool reuse_payload = true;
+	bool alloc_benchmark = false;
+	bool aggregation_benchmark = false;
+	string scheduler = "map";
+	string routing = "global";
+	int scheduler_benchmark = 0;
+	int load_sweep = 0;
+	string loads = "0,0.2,0.4,0.6,0.8";
+	string load_kind = "udp";
+	int station_scaling = 0;
+	int loss_sweep = 0;
+	string loss_rates = "0,0.0001,0.001,0.005,0.01,0.02,0.05";
+	int distance_sweep = 0;
+	string distances = "5,20,40,60,80,100";
+	string cache_dir;
+	int adaptive = 0;
+	int adaptive_min = 40;
+	int adaptive_max = 1500;
+	double adaptive_tolerance = 50;
+	SweepConfig config;
+	config.backhaulRate = "10Mbps";
+	config.backhaulDelay = "100ms";
+	config.appRate = "100Mbps";
+	config.packetsPerFlow = 10000;
+	config.crossUdpLoad = 0;
+	config.crossWebLoad = 0;
+	config.webMeanBytes = 50000;
+	config.crossTcp = 0;
+	config.crossAgent = "NewReno";
+	config.crossDelay = "10ms";
+	config.wifiStandard = "default";
+	config.channelWidth = 0;
+	config.wifiManager = "aarf";
+	config.mcs = 7;
+	config.ampduBytes = -1;
+	config.amsduBytes = -1;
+	config.stations = 1;
+	config.errorRate = 0;
+	config.errorUnit = "packet";
+	config.errorLink = "backhaul";
+	config.retryLimit = 1;
+	config.distance = 5;
+	config.mobility = "static";
+	config.walkSpeed = 1;
 	cmd.AddValue ("agent", "The TCP agent you want to use:", socket_type);
+	cmd.AddValue ("jobs", "Number of worker processes running sweep points in parallel (0 = all cores)", jobs);
+	cmd.AddValue ("backhaul-rate", "Data rate of the link between the two base stations", config.backhaulRate);
+	cmd.AddValue ("backhaul-delay", "Delay of the link between the two base stations", config.backhaulDelay);
+	cmd.AddValue ("wifi-standard", "Wi-Fi standard of the wireless links: default, a, n, ac or ax (5 GHz)", config.wifiStandard);
+	cmd.AddValue ("channel-width", "Wi-Fi channel width in MHz (0 = the standard's default)", config.channelWidth);
+	cmd.AddValue ("wifi-manager", "Wi-Fi rate control: aarf, minstrel or constant (at --mcs)", config.wifiManager);
+	cmd.AddValue ("mcs", "MCS of the constant rate manager (802.11a: index of the OFDM rates 6 to 54 Mbps)", config.mcs);
+	cmd.AddValue ("ampdu", "Largest A-MPDU in bytes (0 = no A-MPDU, -1 = ns-3 default)", config.ampduBytes);
+	cmd.AddValue ("amsdu", "Largest A-MSDU in bytes (0 = no A-MSDU, -1 = ns-3 default)", config.amsduBytes);
+	cmd.AddValue ("stations", "Number of stations in each of the two cells; station i of the first cell sends to station i of the second", config.stations);
+	cmd.AddValue ("station-scaling", "Only run this packet size with 1, 2, 4, ... up to --stations stations per cell and report how the cell scales", station_scaling);
+	cmd.AddValue ("error-rate", "Random loss rate of the RateErrorModel on the lossy links (0 = none)", config.errorRate);
+	cmd.AddValue ("error-unit", "What the error rate counts: packet or bit", config.errorUnit);
+	cmd.AddValue ("error-link", "Links with random loss: backhaul (BaseToBase) or wifi (receptions in both cells)", config.errorLink);
+	cmd.AddValue ("retry-limit", "MAC retransmissions of a frame lost with --error-link=wifi", config.retryLimit);
+	cmd.AddValue ("distance", "Distance in metres between a station and its base station", config.distance);
+	cmd.AddValue ("mobility", "Station placement: static, or walk (random waypoints within --distance of the base station)", config.mobility);
+	cmd.AddValue ("walk-speed", "Speed of the walking stations in m/s", config.walkSpeed);
+	cmd.AddValue ("loss-sweep", "Only run this packet size for every agent at every --loss-rates value and plot throughput vs loss", loss_sweep);
+	cmd.AddValue ("loss-rates", "Comma-separated error rates of the loss sweep", loss_rates);
+	cmd.AddValue ("distance-sweep", "Only run this packet size for every agent at every --distances value and plot throughput vs distance", distance_sweep);
+	cmd.AddValue ("distances", "Comma-separated station distances (m) of the distance sweep", distances);
+	cmd.AddValue ("aggregation-benchmark", "Rerun the sweep without frame aggregation and report the throughput it gains", aggregation_benchmark);
+	cmd.AddValue ("app-rate", "Data rate of the sender in the paced send mode", config.appRate);
+	cmd.AddValue ("packets", "Number of packets the sender sends", config.packetsPerFlow);
+	cmd.AddValue ("xml", "Also write the per-point FlowMonitor XML files (with histograms and probes)", write_xml);
+	cmd.AddValue ("trace", "Sample cwnd, RTT, bytes in flight and goodput into <prefix>_<size>.ts files", trace);
+	cmd.AddValue ("trace-interval", "Seconds between two time-series samples", trace_interval);
+	cmd.AddValue ("trace-buffer", "Number of samples buffered in memory before a batch is written", trace_buffer);
+	cmd.AddValue ("send-mode", "How senders push data: paced (timer at the app data rate) or bulk (refill on free send buffer)", send_mode);
+	cmd.AddValue ("send-benchmark", "Run the sweep in both send modes and compare events and wall time", send_benchmark);
+	cmd.AddValue ("reuse-payload", "Send copies of a preallocated payload template instead of allocating each packet", reuse_payload);
+	cmd.AddValue ("alloc-benchmark", "Run the sweep with and without payload reuse and compare heap allocations and wall time", alloc_benchmark);
+	cmd.AddValue ("scheduler", "Event scheduler: map, heap, list, calendar or priority", scheduler);
+	cmd.AddValue ("routing", "IPv4 routing: global (SPF from every node), nix (nix-vector, on demand) or static (default routes of the topology)", routing);
+	cmd.AddValue ("scheduler-benchmark", "Only run this packet size once under every scheduler and compare them", scheduler_benchmark);
+	cmd.AddValue ("cross-udp", "UDP on/off cross traffic across the backhaul, as a share of its rate (0 = none)", config.crossUdpLoad);
+	cmd.AddValue ("cross-web", "Short web-like TCP transfers across the backhaul, as a share of its rate (0 = none)", config.crossWebLoad);
+	cmd.AddValue ("web-mean", "Mean size in bytes of the web-like transfers (Pareto)", config.webMeanBytes);
+	cmd.AddValue ("cross-tcp", "Number of competing long-lived TCP flows across the backhaul", config.crossTcp);
+	cmd.AddValue ("cross-agent", "Agent of the competing flows: NewReno, Cubic, Westwood, Veno or Vegas", config.crossAgent);
+	cmd.AddValue ("cross-delay", "One-way delay of each cross-traffic access link, which sets the competing flows' RTT", config.crossDelay);
+	cmd.AddValue ("load-sweep", "Only run this packet size at every --loads level of the --load-kind cross traffic", load_sweep);
+	cmd.AddValue ("loads", "Comma-separated cross-traffic loads of the load sweep, as shares of the backhaul rate", loads);
+	cmd.AddValue ("load-kind", "Cross traffic the load sweep varies: udp or web", load_kind);
+	cmd.AddValue ("trace-benchmark", "Rerun the sweep without tracing and report the tracing overhead", trace_benchmark);
+	cmd.AddValue ("converge", "Stop every run once all data is delivered or the goodput is steady", converge);
+	cmd.AddValue ("converge-interval", "Seconds between two convergence checks", converge_interval);
+	cmd.AddValue ("converge-window", "Number of intervals the goodput has to be steady over", converge_window);
+	cmd.AddValue ("converge-tolerance", "Relative 95% confidence half-width of the goodput counted as steady", converge_tolerance);
+	cmd.AddValue ("converge-check", "Rerun the sweep to full length and compare throughput and wall time", converge_check);
+	cmd.AddValue ("replications", "Independent runs of every point (RNG run numbers from --RngRun on); reports mean and 95% CI", replications);
+	cmd.AddValue ("crn", "Use common random numbers: the same run numbers for every agent", crn);
+	cmd.AddValue ("qdisc", "Queue disc on the bottleneck: default, none (device DropTail only), codel, fqcodel, pie or red", qdisc);
+	cmd.AddValue ("queue-unit", "Size the queues to one bandwidth-delay product in packets or in bytes", queue_unit);
+	cmd.AddValue ("delay-bin", "Bin width (seconds) of the FlowMonitor delay and jitter histograms the percentiles come from", delay_bin);
+	cmd.AddValue ("measure", "How flows are measured: flowmon (FlowMonitor) or sink (constant-memory counters on the hosts)", measure);
+	cmd.AddValue ("measure-benchmark", "Run the sweep with both measurement modes and compare throughput, wall time and peak RSS", measure_benchmark);
+	cmd.AddValue ("workload", "Traffic of the senders: cbr (constant-rate packets) or ftp (file transfers)", workload);
+	cmd.AddValue ("ftp-sizes", "File size distribution of the ftp workload: fixed, lognormal or pareto", ftp_sizes);
+	cmd.AddValue ("ftp-mean", "Mean file size of the ftp workload, in bytes", ftp_mean);
+	cmd.AddValue ("ftp-rate", "Poisson arrival rate of transfers per sender and second (0 = one transfer after another)", ftp_rate);
+	cmd.AddValue ("ftp-transfers", "Number of transfers per sender", ftp_transfers);
+	cmd.AddValue ("queue-trace", "Record the queueing delay and occupancy of every packet leaving the bottleneck queue", queue_trace);
+	cmd.AddValue ("cache-dir", "Directory of cached sweep point results; points already in it are not run again", cache_dir);
+	cmd.AddValue ("adaptive", "Instead of the fixed packet sizes, pick this many sizes where the throughput changes most", adaptive);
+	cmd.AddValue ("adaptive-min", "Smallest packet size of the adaptive sweep", adaptive_min);
+	cmd.AddValue ("adaptive-max", "Largest packet size of the adaptive sweep", adaptive_max);
+	cmd.AddValue ("adaptive-tolerance", "Throughput change (Kbps) between neighbouring sizes below which the adaptive sweep stops refining", adaptive_tolerance);
 	cmd.Parse (argc, argv);
 	
-	// setting socket type (according to TCP-agent)
-	if(socket_type=="Westwood")
+	if(jobs<=0)
 	{
-		Config::SetDefault ("ns3::TcpL4Protocol::SocketType", StringValue ("ns3::TcpWestwood"));
+		jobs = sysconf(_SC_NPROCESSORS_ONLN);
 	}
-	else if (socket_type=="Veno")
+	
+	// checking the TCP-agent; every point sets its socket type, and the agent sweeps run all three
+	if(AgentTypeName (socket_type).empty() && loss_sweep==0 && distance_sweep==0)
 	{
-		Config::SetDefault ("ns3::TcpL4Protocol::SocketType", StringValue ("ns3::TcpVeno"));
+		NS_LOG_INFO("Invalid TCP agent, please enter one among {Westwood, Veno, Vegas}");
+		exit(1);
 	}
-	else if (socket_type=="Vegas")
+			
+	
+	config.agent = socket_type;
+	config.writeXml = write_xml;
+	config.trace = trace || trace_benchmark;
+	config.traceInterval = trace_interval;
+	config.traceBuffer = trace_buffer;
+	config.bulkSend = send_mode=="bulk";
+	config.reusePayload = reuse_payload;
+	config.scheduler = scheduler;
+	config.routing = routing;
+	config.isolatePoints = measure_benchmark;
+	config.cacheDir = cache_dir;
+	config.converge = converge || converge_check;
+	config.convergeInterval = converge_interval;
+	config.convergeWindow = converge_window;
+	config.convergeTolerance = converge_tolerance;
+	config.qdisc = qdisc;
+	config.queueBytes = queue_unit=="bytes";
+	config.queueTrace = queue_trace;
+	config.delayBinWidth = delay_bin;
+	config.sinkMeasure = measure=="sink";
+	config.ftp = workload=="ftp";
+	config.ftpSizes = ftp_sizes;
+	config.ftpMeanBytes = ftp_mean;
+	config.ftpArrivalRate = ftp_rate;
+	config.ftpTransfers = ftp_transfers;
+	config.seed = RngSeedManager::GetSeed ();
+	config.run = RngSeedManager::GetRun ();
+	
+	if(routing!="global" && routing!="nix" && routing!="static")
 	{
-		Config::SetDefault ("ns3::TcpL4Protocol::SocketType", StringValue ("ns3::TcpVegas"));
+		NS_LOG_INFO("Invalid routing, please enter one among {global, nix, static}");
+		exit(1);
 	}
-	else
+	
+	if(SchedulerTypeName (scheduler).empty())
 	{
-		NS_LOG_INFO("Invalid TCP agent, please enter one among {Westwood, Veno, Vegas}");
+		NS_LOG_INFO("Invalid scheduler, please enter one among {map, heap, list, calendar, priority}");
 		exit(1);
 	}
-			
 	
-	NS_LOG_INFO("Wireless_TCP - "+ socket_type);
-	NS_LOG_INFO("+-----------------------------------------------+");
-	NS_LOG_INFO("|Packet Size  |   Throughput   |  Fairness Index|");
-	NS_LOG_INFO("+-----------------------------------------------+");
+	if(send_mode!="paced" && send_mode!="bulk")
+	{
+		NS_LOG_INFO("Invalid send mode, please enter one among {paced, bulk}");
+		exit(1);
+	}
+	if((send_benchmark || alloc_benchmark) && config.trace)
+	{
+		NS_LOG_INFO("The send and allocation benchmarks compare untraced runs, please run them without --trace");
+		exit(1);
+	}
+#ifndef COUNT_HEAP_ALLOCATIONS
+	if(alloc_benchmark)
+	{
+		NS_LOG_INFO("The allocation benchmark counts allocations through a replaced operator new, please rebuild with -DCOUNT_HEAP_ALLOCATIONS");
+		exit(1);
+	}
+#endif
+	
+	if(config.trace && trace_interval<=0)
+	{
+		NS_LOG_INFO("Tracing needs a positive --trace-interval");
+		exit(1);
+	}
+	
+	if(adaptive!=0 && (adaptive<3 || adaptive_min<1 || adaptive_max<=adaptive_min || adaptive_tolerance<0))
+	{
+		NS_LOG_INFO("The adaptive sweep needs --adaptive of at least 3 and --adaptive-min < --adaptive-max");
+		exit(1);
+	}
+	
+	if(config.converge && (converge_interval<=0 || converge_window<2 || converge_tolerance<=0))
+	{
+		NS_LOG_INFO("Early termination needs a positive --converge-interval and --converge-tolerance and a --converge-window of at least 2");
+		exit(1);
+	}
+	
+	int standard_index = WifiStandardIndex (config.wifiStandard);
+	if(standard_index<0 || (config.wifiManager!="aarf" && config.wifiManager!="minstrel" && config.wifiManager!="constant"))
+	{
+		NS_LOG_INFO("Invalid Wi-Fi setup, please enter a --wifi-standard among {default, a, n, ac, ax} and a --wifi-manager among {aarf, minstrel, constant}");
+		exit(1);
+	}
+	if(standard_index==0 && (config.channelWidth!=0 || config.wifiManager!="aarf"))
+	{
+		NS_LOG_INFO("--channel-width and --wifi-manager need an explicit --wifi-standard");
+		exit(1);
+	}
+	if(standard_index>0 && (config.mcs>WIFI_MAX_MCS[standard_index] || config.channelWidth>WIFI_MAX_WIDTH[standard_index]
+		|| (config.channelWidth!=0 && config.channelWidth!=20 && config.channelWidth!=40 && config.channelWidth!=80 && config.channelWidth!=160)))
+	{
+		NS_LOG_INFO("Invalid Wi-Fi rate, 802.11"+ config.wifiStandard +" has MCS 0 to "+ to_string(WIFI_MAX_MCS[standard_index]) +" and channels of 20 up to "+ to_string(WIFI_MAX_WIDTH[standard_index]) +" MHz");
+		exit(1);
+	}
+	if(config.ampduBytes<-1 || config.amsduBytes<-1 || ((config.ampduBytes>0 || config.amsduBytes>0 || aggregation_benchmark) && standard_index<2))
+	{
+		NS_LOG_INFO("Frame aggregation needs --wifi-standard n, ac or ax, and --ampdu/--amsdu of -1, 0 or a size in bytes");
+		exit(1);
+	}
+	if(standard_index>=2 && (config.ampduBytes>WIFI_MAX_AMPDU[standard_index] || config.amsduBytes>WIFI_MAX_AMSDU[standard_index]))
+	{
+		NS_LOG_INFO("Invalid aggregation size, 802.11"+ config.wifiStandard +" takes A-MPDUs of up to "+ to_string(WIFI_MAX_AMPDU[standard_index]) +" bytes and A-MSDUs of up to "+ to_string(WIFI_MAX_AMSDU[standard_index]) +" bytes");
+		exit(1);
+	}
+	
+	vector<double> sweep_values;
+	if(config.errorRate<0 || config.errorRate>=1 || (config.errorUnit!="packet" && config.errorUnit!="bit") || (config.errorLink!="wifi" && config.errorLink!="backhaul")
+		|| (loss_sweep>0 && (!ParseValues (loss_rates, sweep_values) || *min_element (sweep_values.begin(), sweep_values.end())<0 || *max_element (sweep_values.begin(), sweep_values.end())>=1)))
+	{
+		NS_LOG_INFO("Invalid random loss, please enter error rates in [0, 1), an --error-unit among {packet, bit} and an --error-link among {backhaul, wifi}");
+		exit(1);
+	}
+	if(config.distance<=0 || (config.mobility!="static" && config.mobility!="walk") || config.walkSpeed<=0
+		|| (distance_sweep>0 && (!ParseValues (distances, sweep_values) || *min_element (sweep_values.begin(), sweep_values.end())<=0)))
+	{
+		NS_LOG_INFO("Invalid station placement, please enter positive distances, a --mobility among {static, walk} and a positive --walk-speed");
+		exit(1);
+	}
+	if(loss_sweep>0 && distance_sweep>0)
+	{
+		NS_LOG_INFO("Please run the loss and the distance sweeps one at a time");
+		exit(1);
+	}
+	
+	if(config.stations<1 || config.stations>250 || station_scaling<0)
+	{
+		NS_LOG_INFO("Invalid number of stations, please enter between 1 and 250 --stations per cell (one /24 subnet each)");
+		exit(1);
+	}
+	
+	if(!IsQueueDiscName (qdisc) || (queue_unit!="packets" && queue_unit!="bytes"))
+	{
+		NS_LOG_INFO("Invalid queue setup, please enter a --qdisc among {default, none, codel, fqcodel, pie, red} and a --queue-unit among {packets, bytes}");
+		exit(1);
+	}
+	if((workload!="cbr" && workload!="ftp") || (ftp_sizes!="fixed" && ftp_sizes!="lognormal" && ftp_sizes!="pareto") || ftp_mean<1 || ftp_rate<0)
+	{
+		NS_LOG_INFO("Invalid workload, please enter a --workload among {cbr, ftp}, --ftp-sizes among {fixed, lognormal, pareto} and a positive --ftp-mean");
+		exit(1);
+	}
+	if(config.ftp && (config.trace || config.converge || send_benchmark || alloc_benchmark))
+	{
+		NS_LOG_INFO("The ftp workload has no constant-rate sender to trace, stop early or benchmark");
+		exit(1);
+	}
+	if(delay_bin<=0)
+	{
+		NS_LOG_INFO("Invalid --delay-bin, please enter a positive bin width in seconds");
+		exit(1);
+	}
+	if((measure!="flowmon" && measure!="sink") || ((config.sinkMeasure || measure_benchmark) && write_xml))
+	{
+		NS_LOG_INFO("Invalid measurement mode, please enter a --measure among {flowmon, sink}; the sink mode writes no FlowMonitor XML");
+		exit(1);
+	}
+	vector<double> load_levels;
+	if(config.crossUdpLoad<0 || config.crossUdpLoad>=1 || config.crossWebLoad<0 || config.crossWebLoad>=1 || config.webMeanBytes<1
+		|| config.crossTcp>64 || CrossAgentTypeName (config.crossAgent).empty() || (load_kind!="udp" && load_kind!="web")
+		|| (load_sweep>0 && (!ParseValues (loads, load_levels) || *min_element (load_levels.begin(), load_levels.end())<0 || *max_element (load_levels.begin(), load_levels.end())>=1)))
+	{
+		NS_LOG_INFO("Invalid cross traffic, please enter loads in [0, 1), at most 64 --cross-tcp flows, a --cross-agent among {NewReno, Cubic, Westwood, Veno, Vegas} and a --load-kind among {udp, web}");
+		exit(1);
+	}
+	if(replications<1 || (replications>1 && adaptive>0))
+	{
+		NS_LOG_INFO("Invalid number of replications, please enter at least 1 (and do not combine replications with --adaptive)");
+		exit(1);
+	}
+	// without common random numbers every agent draws from its own block of run numbers
+	uint32_t first_run = config.run;
+	if(replications>1 && !crn)
+	{
+		uint32_t agent_index = socket_type=="Westwood" ? 0 : socket_type=="Veno" ? 1 : 2;
+		first_run += agent_index*replications;
+	}
+	
+	// points with side outputs (XML, time series) or whose run times are compared are always run
+	if(!config.cacheDir.empty())
+	{
+		if(config.trace || queue_trace || write_xml || send_benchmark || alloc_benchmark || measure_benchmark || aggregation_benchmark || converge_check || scheduler_benchmark>0 || station_scaling>0)
+		{
+			NS_LOG_INFO("Not using the result cache: --xml, --trace and the benchmarks need fresh runs");
+			config.cacheDir = "";
+		}
+		else
+			config.binaryHash = BinaryFingerprint ();
+	}
+	
+	if(scheduler_benchmark>0)
+	{
+		RunSchedulerBenchmark (config, scheduler_benchmark);
+		return 0;
+	}
+	if(load_sweep>0)
+	{
+		RunLoadSweep (config, load_sweep, load_kind, load_levels, jobs);
+		return 0;
+	}
+	if(station_scaling>0)
+	{
+		RunStationScaling (config, station_scaling);
+		return 0;
+	}
+	if(loss_sweep>0 || distance_sweep>0)
+	{
+		RunAgentSweep (config, loss_sweep>0 ? loss_sweep : distance_sweep, loss_sweep>0 ? "loss" : "distance", sweep_values, jobs);
+		return 0;
+	}
+	
+	NS_LOG_INFO("Wireless_TCP - "+ socket_type +" ("+ DescribeWifi (config) +")");
+	NS_LOG_INFO("+---------------------------------------------------------------------------------------------------------------------------------------------------------------------+");
+	NS_LOG_INFO("|Packet Size  |   Throughput   |    Goodput    |  Fairness Index| p99 Delay (ms) | p99 Jitter (ms) |  Setup (s)  |  Wall (s)  |   Events   | Events/sec | Sim/Wall | Peak RSS (KB) |");
+	NS_LOG_INFO("+---------------------------------------------------------------------------------------------------------------------------------------------------------------------+");
 	
 	
 	//Generating Plots
 	string graphicsFileName = "Wireless_TCP_"+socket_type+".png";
 	string plotFileName = "Wireless_TCP_"+socket_type+".plt";
-	string plotTitle = "Throughput vs Packet size for TCP-"+socket_type;
+	string plotTitle = "Throughput vs Packet size for TCP-"+socket_type+" ("+ DescribeWifi (config) +")";
 	string dataTitle = "TCP-"+socket_type;
 	
 	Gnuplot plot (graphicsFileName);
@@ -191,184 +1494,138 @@ int main(int argc, char *argv[])
   	
 	int packet_sizes[10]={40, 44, 48, 52, 60, 552, 576, 628, 1420, 1500};
 	
-	for(int i=0;i<10;i++)
+	vector<int> segment_sizes (packet_sizes, packet_sizes+10);
+	vector<SweepResult> results;
+	vector<SweepResult> replicationRuns;
+	vector<ReplicationSummary> summaries;
+	if(adaptive>0)
 	{
+		results = RunAdaptiveSweep (config, adaptive_min, adaptive_max, adaptive, adaptive_tolerance, jobs);
+		segment_sizes.clear();
+		for(size_t i=0;i<results.size();i++)
+			segment_sizes.push_back (results[i].segmentSize);
+		plot.AppendExtra ("set xrange ["+ to_string(adaptive_min-20) +":"+ to_string(adaptive_max+20) +"]");
+	}
+	else if(replications>1)
+	{
+		replicationRuns = RunReplicatedSweep (config, segment_sizes, replications, first_run, jobs);
+		summaries = SummarizeReplications (replicationRuns, replications, results);
+		dataset.SetErrorBars (Gnuplot2dDataset::Y);
+	}
+	else
+		results = RunSweep (config, segment_sizes, jobs);
 	
-		//setting segment size
-		int segment_size=packet_sizes[i];
-		Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (segment_size));	
-		
-		
-		//creating nodes
-		NodeContainer nodes;
-		nodes.Create(4);
-		
-		//creating wired-links
-		PointToPointHelper BaseToBase;
-  		BaseToBase.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
-  		BaseToBase.SetChannelAttribute ("Delay", StringValue ("100ms"));
-  		int mxPacketsInQueue = (10*100*1000)/(8*segment_size);
-  		BaseToBase.SetQueue("ns3::DropTailQueue<Packet>", "MaxSize", StringValue(to_string(mxPacketsInQueue)+"p"));
-  		
-  		  		
-  		
-  		//setting up wired-links between base-stations
-  		NetDeviceContainer path_BS1BS2;
-  		path_BS1BS2 = BaseToBase.Install( nodes.Get(1), nodes.Get(2));
-  		
-  		
-  		//setting up wireless-links between host and base-station
-  		YansWifiChannelHelper N0BS1 = YansWifiChannelHelper::Default ();
-  		YansWifiPhyHelper phy_N0BS1;
-  		phy_N0BS1.SetChannel (N0BS1.Create ());
-  		
-  		YansWifiChannelHelper N1BS2 = YansWifiChannelHelper::Default ();
-  		YansWifiPhyHelper phy_N1BS2;
-  		phy_N1BS2.SetChannel (N1BS2.Create ());
-  		
-  		// creating and setting wifi
-  		WifiHelper wifi;
-  		wifi.SetRemoteStationManager ("ns3::AarfWifiManager");
-
-  		WifiMacHelper mac;
-  		Ssid ssid = Ssid ("ns-3-ssid");
-  		
-  		
-  		//installing wifi on basestations
-  		mac.SetType ("ns3::StaWifiMac",
-               	"Ssid", SsidValue (ssid),
-               	"ActiveProbing", BooleanValue (false));           
-               NetDeviceContainer accessPoint_BS1, accessPoint_BS2;
-  		accessPoint_BS1 = wifi.Install(phy_N0BS1, mac, nodes.Get(1));
-  		accessPoint_BS2 = wifi.Install(phy_N1BS2, mac, nodes.Get(2));
-               
-               
-               // installing wifi on hosts
-               mac.SetType ("ns3::ApWifiMac",
-               	"Ssid", SsidValue (ssid));
-
-  		NetDeviceContainer endPoint_N0, endPoint_N1;
-  		endPoint_N0 = wifi.Install (phy_N0BS1, mac, nodes.Get(0));
-  		endPoint_N1 = wifi.Install (phy_N1BS2, mac, nodes.Get(3));
-  		
-  		
-  		// Setting wireless links between hosts and basestations
-  		NetDeviceContainer path_N0BS1(endPoint_N0, accessPoint_BS1);
-  		NetDeviceContainer path_N1BS2(accessPoint_BS2, endPoint_N1);        
-  		
-  		
-  		//Setting positions of devices
-  		MobilityHelper mobility;
-
-  		mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
-                                 		"MinX", DoubleValue (0.0),
-                                 		"MinY", DoubleValue (0.0),
-                                 		"DeltaX", DoubleValue (5.0),
-                                 		"DeltaY", DoubleValue (10.0),
-                                 		"GridWidth", UintegerValue (3),
-                                 		"LayoutType", StringValue ("RowFirst"));
-
-               mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
-               
-         	mobility.Install(nodes.Get(0));
-    	 	mobility.Install(nodes.Get(1));
-    		mobility.Install(nodes.Get(2));
-    		mobility.Install(nodes.Get(3));
-
-               
-  		//building Internet stack
-  		InternetStackHelper stack;
-  		stack.Install(nodes);
-  		
-  		
-  		//assigning Ip addresses
-  		Ipv4AddressHelper ipv4_N0BS1;
-	      	ipv4_N0BS1.SetBase( "10.1.1.0" , "255.255.255.0" );
-	      	Ipv4InterfaceContainer N0BS1Interface = ipv4_N0BS1.Assign (path_N0BS1);
-
-	      	Ipv4AddressHelper ipv4_BS1BS2;
-	      	ipv4_BS1BS2.SetBase( "10.1.2.0" , "255.255.255.0" );
-	      	Ipv4InterfaceContainer BS1BS2Interface = ipv4_BS1BS2.Assign (path_BS1BS2);
-
-	      	Ipv4AddressHelper ipv4_N1BS2;
-	      	ipv4_N1BS2.SetBase( "10.1.3.0" , "255.255.255.0" );
-	      	Ipv4InterfaceContainer N1BS2Interface = ipv4_N1BS2.Assign (path_N1BS2);
-	      	
-	      	
-	      	//Assigning port Number;
-	      	uint16_t sinkPort = 9897;
-
+	//flow statistics of the whole sweep go into one binary file, point by point
+	ofstream flowFile(("wireless_TCP_"+socket_type+".flows").c_str(), ios::binary);
+	flowFile.write (FLOW_FILE_MAGIC, sizeof (FLOW_FILE_MAGIC));
+	ofstream perfFile(("wireless_TCP_"+socket_type+"_perf.csv").c_str());
+	ofstream metricsFile(("wireless_TCP_"+socket_type+"_flowmetrics.csv").c_str());
 	
-	      	Address sinkAddress = InetSocketAddress (N1BS2Interface.GetAddress (1), sinkPort);
-      		Address anyAddress = InetSocketAddress (Ipv4Address::GetAny (), sinkPort);
-      		//Creating application container
-      		PacketSinkHelper packetSinkHelper ("ns3::TcpSocketFactory", anyAddress);
-      		ApplicationContainer sinkApps = packetSinkHelper.Install (nodes.Get (3));
-      		//Set the start and stop times for the server-side
-      		sinkApps.Start (Seconds (0.));
-  		sinkApps.Stop (Seconds (20.));
-
-
-      		// Create a client socket
-      		Ptr<Socket> ns3TcpSocket = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
-      		//Create an Application
-      		Ptr<SimulatorApp> simulApp = CreateObject<SimulatorApp> ();
-      		simulApp->Setup(ns3TcpSocket, sinkAddress, segment_size, 10000, DataRate ("100Mbps"));  //can we change 1000, 20Mbps
-      		nodes.Get(0)->AddApplication(simulApp);
-      		//Set the start and stop times for the client-side
-      		simulApp->SetStartTime (Seconds (0.));
-      		simulApp->SetStopTime (Seconds (20.));
-
-
-		//populating routing tables         
-      		Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
-      		
-
-		//Flow monitor
-		Ptr<FlowMonitor> flowMonitor;
-		FlowMonitorHelper flowHelper;
-		flowMonitor = flowHelper.InstallAll();
-		
-		Simulator::Stop (Seconds (20));
-  		Simulator::Run ();
-  		
-  		// Output the data in xml format
-		flowMonitor->SerializeToXmlFile("wireless_TCP_"+socket_type+"_"+std::to_string(segment_size)+".xml", true, true);
-  		
-  		//Obtaining statistics 
-  		auto statistics=flowMonitor->GetFlowStats().begin();
-  		
-  		double totData = 8.0 * statistics->second.rxBytes;
-  		double totTime = statistics->second.timeLastRxPacket.GetSeconds()-statistics->second.timeFirstRxPacket.GetSeconds();
-  		
-  		double throughput = totData/(1000*totTime);
-  		
-  		double sumThroughput=0;
-  		double sumSqThroughput=0;
-  		int n=0;
-  		
-  		sumThroughput += throughput;
-  		sumSqThroughput += throughput*throughput;
-  		n++;
-  		
-  		double jain_fairness = (sumThroughput*sumThroughput)/((n+0.0)*sumSqThroughput);
-  		
-  		Simulator::Destroy ();
-  		  		
-  		
-  		//Output results
-  		if(segment_size>=1000)
-  			NS_LOG_INFO("|    "+ to_string(segment_size) +"     |   "+ to_string(throughput) +"   |    "+ to_string(jain_fairness)+"    |");
-  		else if(segment_size<100)
-  			NS_LOG_INFO("|    "+ to_string(segment_size) +"       |   "+ to_string(throughput) +"   |    "+ to_string(jain_fairness)+"    |");
-  		else
-  			NS_LOG_INFO("|    "+ to_string(segment_size) +"      |   "+ to_string(throughput) +"   |    "+ to_string(jain_fairness)+"    |");
-  			
-  		//adding values to dataset
-      		dataset.Add (segment_size, throughput);
-
-	}
-	NS_LOG_INFO("+-----------------------------------------------+");
+	size_t reused = 0;
+	for(size_t i=0;i<results.size();i++)
+	{
+		// Output results
+		PrintResultRow (results[i]);
+		if(results[i].cached)
+			reused++;
+		flowFile.write (results[i].flowRecords.data(), results[i].flowRecords.size());
+		WritePerfRow (perfFile, socket_type, results[i]);
+		WriteFlowMetrics (metricsFile, socket_type, results[i]);
+			
+		//adding values to dataset
+		if(summaries.empty())
+      			dataset.Add (results[i].segmentSize, results[i].throughput);
+		else
+			dataset.Add (summaries[i].segmentSize, summaries[i].mean, summaries[i].halfWidth);
+	}
+	NS_LOG_INFO("+---------------------------------------------------------------------------------------------------------------------------------------------------------------------+");
+	if(!config.cacheDir.empty())
+		NS_LOG_INFO(to_string(reused) +" of "+ to_string(results.size()) +" points taken from the result cache in "+ config.cacheDir);
+	if(config.converge)
+	{
+		int stops[3]={0, 0, 0};
+		double simulated=0;
+		for(size_t i=0;i<results.size();i++)
+		{
+			stops[results[i].stopReason]++;
+			simulated += results[i].simulatedSeconds;
+		}
+		NS_LOG_INFO("Early termination: "+ to_string(stops[STOP_COMPLETED]) +" points completed, "+ to_string(stops[STOP_STEADY]) +" steady, "+ to_string(stops[STOP_FULL_LENGTH]) +" ran to full length; "+ to_string(simulated) +" of "+ to_string(20.0*results.size()) +" simulated seconds");
+	}
+	if(adaptive>0)
+		NS_LOG_INFO("Adaptive sweep: "+ to_string(results.size()) +" packet sizes, largest throughput step between neighbours "+ to_string(LargestThroughputStep (results)) +" Kbps");
+	PrintLatencyReport (results);
+	WriteLatencyPlot ("Wireless_TCP_"+socket_type+"_latency.plt", socket_type, results);
+	if(qdisc!="default" || queue_trace)
+		PrintQueueReport (results);
+	if(HasCrossTraffic (config))
+		PrintCrossTrafficReport (config, results);
+	if(config.ftp)
+	{
+		PrintTransferReport (results);
+		WriteTransferPlot ("Wireless_TCP_"+socket_type+"_fct.plt", socket_type, results);
+	}
+	if(!summaries.empty())
+	{
+		PrintReplicationSummary (summaries);
+		WriteReplications ("wireless_TCP_"+socket_type+"_replications.csv", socket_type, replicationRuns);
+	}
+	
+	if(converge_check)
+	{
+		SweepConfig full = config;
+		full.converge = false;
+		full.trace = false;
+		full.writeXml = false;
+		PrintConvergenceCheck (results, RunSweep (full, segment_sizes, jobs), converge_tolerance);
+	}
+	if(aggregation_benchmark)
+	{
+		SweepConfig plain = config;
+		plain.ampduBytes = 0;
+		plain.amsduBytes = 0;
+		plain.writeXml = false;
+		PrintAggregationGain (results, RunSweep (plain, segment_sizes, jobs));
+	}
+	if(trace_benchmark)
+	{
+		SweepConfig untraced = config;
+		untraced.trace = false;
+		untraced.writeXml = false;
+		PrintTraceOverhead (results, RunSweep (untraced, segment_sizes, jobs));
+	}
+	if(alloc_benchmark)
+	{
+		SweepConfig other = config;
+		other.reusePayload = !config.reusePayload;
+		other.writeXml = false;
+		vector<SweepResult> otherResults = RunSweep (other, segment_sizes, jobs);
+		if(config.reusePayload)
+			PrintAllocationBenchmark (otherResults, results);
+		else
+			PrintAllocationBenchmark (results, otherResults);
+	}
+	if(measure_benchmark)
+	{
+		SweepConfig other = config;
+		other.sinkMeasure = !config.sinkMeasure;
+		vector<SweepResult> otherResults = RunSweep (other, segment_sizes, jobs);
+		if(config.sinkMeasure)
+			PrintMeasurementBenchmark (otherResults, results);
+		else
+			PrintMeasurementBenchmark (results, otherResults);
+	}
+	if(send_benchmark)
+	{
+		SweepConfig other = config;
+		other.bulkSend = !config.bulkSend;
+		other.writeXml = false;
+		vector<SweepResult> otherResults = RunSweep (other, segment_sizes, jobs);
+		if(config.bulkSend)
+			PrintSendModeComparison (otherResults, results);
+		else
+			PrintSendModeComparison (results, otherResults);
+	}
 	
 	//adding dataset and generating output file
   	plot.AddDataset (dataset);